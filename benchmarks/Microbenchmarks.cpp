@@ -0,0 +1,179 @@
+/**
+ * @brief Microbenchmarks of the simulator's hot paths in isolation,
+ * without running a SimGrid simulation.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <wrench-dev.h>
+
+#include "SimpleSimulator.h"
+#include "LRU_FileList.h"
+#include "Workload.h"
+#include "ResultWriter.h"
+#include "computation/CacheComputation.h"
+
+#include <random>
+
+
+/**
+ * @brief Pool of files registered once in the simulation's file catalog and shared by all benchmarks
+ *
+ * @param num_files Number of files needed
+ * @return const std::vector<std::shared_ptr<wrench::DataFile>>&
+ */
+static const std::vector<std::shared_ptr<wrench::DataFile>>& filePool(size_t num_files) {
+    static std::vector<std::shared_ptr<wrench::DataFile>> files;
+    while (files.size() < num_files) {
+        files.push_back(wrench::Simulation::addFile("bench_file_" + std::to_string(files.size()), 1.e9));
+    }
+    return files;
+}
+
+/**
+ * @brief Unique names for workloads and their files created repeatedly in benchmark loops
+ */
+static std::string uniqueName(const std::string& prefix) {
+    static size_t counter = 0;
+    return prefix + std::to_string(counter++);
+}
+
+
+// LRU_FileList::touchFile for files not yet in the list
+static void BM_LRU_TouchNew(benchmark::State& state) {
+    const auto& files = filePool(state.range(0));
+    for (auto _ : state) {
+        LRU_FileList lru;
+        for (int64_t i = 0; i < state.range(0); i++) {
+            lru.touchFile(files[i].get());
+        }
+        benchmark::DoNotOptimize(lru.getNumFiles());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LRU_TouchNew)->RangeMultiplier(4)->Range(1<<8, 1<<20);
+
+// LRU_FileList::touchFile for files already in the list
+static void BM_LRU_TouchExisting(benchmark::State& state) {
+    const auto& files = filePool(state.range(0));
+    LRU_FileList lru;
+    for (int64_t i = 0; i < state.range(0); i++) {
+        lru.touchFile(files[i].get());
+    }
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<size_t> index(0, state.range(0) - 1);
+    for (auto _ : state) {
+        lru.touchFile(files[index(generator)].get());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LRU_TouchExisting)->RangeMultiplier(4)->Range(1<<8, 1<<20);
+
+// LRU_FileList::hasFile for a mix of contained and missing files
+static void BM_LRU_HasFile(benchmark::State& state) {
+    const auto& files = filePool(2 * state.range(0));
+    LRU_FileList lru;
+    for (int64_t i = 0; i < state.range(0); i++) {
+        lru.touchFile(files[2 * i].get());
+    }
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<size_t> index(0, files.size() - 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lru.hasFile(files[index(generator)]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LRU_HasFile)->RangeMultiplier(8)->Range(1<<8, 1<<20);
+
+// LRU_FileList::removeLRUFile until the list is empty
+static void BM_LRU_Evict(benchmark::State& state) {
+    const auto& files = filePool(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        LRU_FileList lru;
+        for (int64_t i = 0; i < state.range(0); i++) {
+            lru.touchFile(files[i].get());
+        }
+        state.ResumeTiming();
+        for (int64_t i = 0; i < state.range(0); i++) {
+            benchmark::DoNotOptimize(lru.removeLRUFile());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LRU_Evict)->RangeMultiplier(4)->Range(1<<8, 1<<20);
+
+// Source resolution of determineFileSourcesAndCache: look up files in the reachable caches,
+// which are identified by plain indices, so no storage service needs to be instantiated
+static void BM_LookupFileSources(benchmark::State& state) {
+    const std::vector<size_t> caches = {0, 1, 2, 3};
+    const auto& files = filePool(state.range(0));
+    std::map<size_t, LRU_FileList> file_map;
+    // Every cache holds a quarter of the files, half of the files are nowhere
+    for (int64_t i = 0; i < state.range(0); i += 2) {
+        file_map[caches[(i / 2) % caches.size()]].touchFile(files[i].get());
+    }
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<size_t> index(0, state.range(0) - 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(CacheComputation::lookupFile(files[index(generator)], caches, file_map));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LookupFileSources)->RangeMultiplier(8)->Range(1<<8, 1<<20);
+
+// Workload::sampleJob for all jobs of a workload including the registration of their files
+static void BM_SampleJobs(benchmark::State& state) {
+    Workload::sampling_threads = 1;
+    for (auto _ : state) {
+        Workload workload(
+            state.range(0), 10, 1,
+            2164428000000, 216442800000, 2000000000, 200000000,
+            3600000000, 360000000, 18000000000, 1800000000,
+            WorkloadType::Streaming, uniqueName("bench_workload_"), 0., 42
+        );
+        benchmark::DoNotOptimize(workload.job_batch.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SampleJobs)->RangeMultiplier(8)->Range(1<<6, 1<<15)->Unit(benchmark::kMillisecond);
+
+// duplicateJobs creating replicas with new output files
+static void BM_DuplicateJobs(benchmark::State& state) {
+    Workload::sampling_threads = 1;
+    const size_t duplications = 4;
+    for (auto _ : state) {
+        state.PauseTiming();
+        Workload workload(
+            state.range(0), 10, 1,
+            2164428000000, 216442800000, 2000000000, 200000000,
+            3600000000, 360000000, 18000000000, 1800000000,
+            WorkloadType::Streaming, uniqueName("bench_duplication_"), 0., 42
+        );
+        state.ResumeTiming();
+        auto replicas = duplicateJobs(workload.job_batch, duplications, {});
+        benchmark::DoNotOptimize(replicas.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * duplications);
+}
+BENCHMARK(BM_DuplicateJobs)->RangeMultiplier(8)->Range(1<<6, 1<<15)->Unit(benchmark::kMillisecond);
+
+// Formatting of the job records in the completion handler's output
+static void BM_CSVOutput(benchmark::State& state) {
+    CSVResultWriter writer("/dev/null");
+    JobRecord record = {
+        "job_workload_123456", "workload", "worker123.site.example.org", 0.75,
+        12.5, 130.25, 45789.125, 117.75,
+        40123.456789, 1234.5, 0.875,
+        5432.1, 36000000000., 27000000000., 9000000000.,
+        321.5, 18000000000.
+    };
+    for (auto _ : state) {
+        writer.write(record);
+    }
+    writer.close();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CSVOutput);
+
+BENCHMARK_MAIN();
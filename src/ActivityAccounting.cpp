@@ -0,0 +1,127 @@
+
+
+#include "ActivityAccounting.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+
+ActivityCounters& ActivityCounters::operator+=(const ActivityCounters& other) {
+    this->execs += other.execs;
+    this->reads += other.reads;
+    this->writes += other.writes;
+    this->file_creations += other.file_creations;
+    this->file_deletions += other.file_deletions;
+    this->messages += other.messages;
+    return *this;
+}
+
+/**
+ * @brief Number of messages a storage service exchanges to transfer data:
+ * request and answer, plus one message per filled buffer.
+ * Without buffer (0) the data flows continuously, with infinite buffer in a single message.
+ *
+ * @param num_bytes Amount of data transferred
+ * @param buffer_size Buffer size of the storage service in bytes
+ * @return size_t
+ */
+size_t ActivityCounters::messagesPerTransfer(double num_bytes, double buffer_size) {
+    size_t messages = 2;
+    if (buffer_size <= 0.) {
+        return messages;
+    }
+    if (std::isinf(buffer_size)) {
+        return messages + 1;
+    }
+    return messages + static_cast<size_t>(std::ceil(num_bytes / buffer_size));
+}
+
+/**
+ * @brief Construct the accounting
+ *
+ * @param block_size Block size of the streamed input-files in bytes
+ * @param buffer_setting Buffer size setting of the storage services
+ * @param jobs_filename Path for a CSV file with the counters per job, empty to not write them
+ *
+ * @throw std::runtime_error
+ */
+ActivityAccounting::ActivityAccounting(double block_size, const std::string& buffer_setting, const std::string& jobs_filename) {
+    this->block_size = block_size;
+    this->buffer_setting = buffer_setting;
+    if (!jobs_filename.empty()) {
+        this->jobs_file.open(jobs_filename, std::ios::out | std::ios::trunc);
+        if (!this->jobs_file.is_open()) {
+            throw std::runtime_error("Couldn't open activity file " + jobs_filename + " for dump!");
+        }
+        this->jobs_file << "job.tag, workload, workload.type, execs, reads, writes, filecreations, filedeletions, messages\n";
+    }
+}
+
+/**
+ * @brief Account the activities of a completed job
+ *
+ * @param job_tag Name of the job
+ * @param workload Name of the job's workload
+ * @param workload_type Type of the job's workload
+ * @param counters Activities issued for the job
+ */
+void ActivityAccounting::addJob(const std::string& job_tag, const std::string& workload, const std::string& workload_type, const ActivityCounters& counters) {
+    for (auto aggregate : {&this->per_workload[{workload, workload_type}], &this->per_workload_type[workload_type], &this->total}) {
+        aggregate->jobs++;
+        aggregate->counters += counters;
+    }
+    if (this->jobs_file.is_open()) {
+        this->jobs_file << job_tag << ", " << workload << ", " << workload_type << ", "
+            << counters.execs << ", " << counters.reads << ", " << counters.writes << ", "
+            << counters.file_creations << ", " << counters.file_deletions << ", " << counters.messages << "\n";
+    }
+}
+
+/**
+ * @brief Write the counters per workload, per workload type and in total as CSV file
+ *
+ * @param filename Path of the CSV file
+ *
+ * @throw std::runtime_error
+ */
+void ActivityAccounting::write(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Couldn't open activity report " + filename + " for dump!");
+    }
+    file << "workload, workload.type, xrd.blocksize, storage.buffer, jobs, execs, reads, writes, filecreations, filedeletions, messages\n";
+    auto write_row = [&](const std::string& workload, const std::string& workload_type, const Aggregate& aggregate) {
+        const auto& c = aggregate.counters;
+        file << workload << ", " << workload_type << ", " << this->block_size << ", " << this->buffer_setting << ", "
+             << aggregate.jobs << ", " << c.execs << ", " << c.reads << ", " << c.writes << ", "
+             << c.file_creations << ", " << c.file_deletions << ", " << c.messages << "\n";
+    };
+    for (const auto& [key, aggregate] : this->per_workload) {
+        write_row(key.first, key.second, aggregate);
+    }
+    for (const auto& [workload_type, aggregate] : this->per_workload_type) {
+        write_row("all", workload_type, aggregate);
+    }
+    write_row("all", "all", this->total);
+    if (!file.good()) {
+        throw std::runtime_error("Failed writing activity report " + filename + "!");
+    }
+}
+
+/**
+ * @brief Print the total counters and their average per job
+ *
+ * @param os Stream to print into
+ */
+void ActivityAccounting::print(std::ostream& os) const {
+    const auto& c = this->total.counters;
+    double jobs = std::max<size_t>(this->total.jobs, 1);
+    os << "Simulated activities of " << this->total.jobs << " jobs (per job): "
+       << c.execs << " execs (" << c.execs / jobs << "), "
+       << c.reads << " reads (" << c.reads / jobs << "), "
+       << c.writes << " writes (" << c.writes / jobs << "), "
+       << c.file_creations << " file creations (" << c.file_creations / jobs << "), "
+       << c.file_deletions << " file deletions (" << c.file_deletions / jobs << "), "
+       << c.messages << " messages (" << c.messages / jobs << ")" << std::endl;
+}
@@ -0,0 +1,61 @@
+
+
+#ifndef S_ACTIVITYACCOUNTING_H
+#define S_ACTIVITYACCOUNTING_H
+
+#include <cstddef>
+#include <fstream>
+#include <map>
+#include <ostream>
+#include <string>
+
+/**
+ * @brief Counts of the simulation activities issued on behalf of a job
+ */
+struct ActivityCounters {
+    size_t execs = 0;
+    size_t reads = 0;
+    size_t writes = 0;
+    size_t file_creations = 0;
+    size_t file_deletions = 0;
+    /** @brief messages exchanged with storage services, modeled from the storage buffer size **/
+    size_t messages = 0;
+
+    ActivityCounters& operator+=(const ActivityCounters& other);
+
+    static size_t messagesPerTransfer(double num_bytes, double buffer_size);
+};
+
+/**
+ * @brief Accounting of the simulation cost of the jobs, aggregated per workload and per workload type
+ * for the block size and storage buffer setting of the run, and optionally written per job.
+ */
+class ActivityAccounting {
+public:
+    ActivityAccounting(double block_size, const std::string& buffer_setting, const std::string& jobs_filename = "");
+
+    void addJob(const std::string& job_tag, const std::string& workload, const std::string& workload_type, const ActivityCounters& counters);
+
+    void write(const std::string& filename) const;
+    void print(std::ostream& os) const;
+
+private:
+    /**
+     * @brief Counters summed over the jobs of a group
+     */
+    struct Aggregate {
+        size_t jobs = 0;
+        ActivityCounters counters;
+    };
+
+    double block_size;
+    std::string buffer_setting;
+
+    std::map<std::pair<std::string, std::string>, Aggregate> per_workload;
+    std::map<std::string, Aggregate> per_workload_type;
+    Aggregate total;
+
+    std::ofstream jobs_file;
+};
+
+#endif //S_ACTIVITYACCOUNTING_H
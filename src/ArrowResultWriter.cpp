@@ -0,0 +1,186 @@
+
+
+#ifdef DCSIM_WITH_ARROW
+
+#include "ArrowResultWriter.h"
+
+#include <stdexcept>
+
+
+/** @brief Names of the floating point columns in the order of the job record */
+static const std::vector<std::string> value_columns = {
+    "hitrate",
+    "job.submit", "job.start", "job.end", "job.queuewait",
+    "job.computetime", "job.iostalltime", "job.overlap",
+    "infiles.transfertime", "infiles.size", "infiles.cachedsize", "infiles.remotesize",
+    "outfiles.transfertime", "outfiles.size"
+};
+
+/**
+ * @brief Throw on a failed Arrow operation
+ */
+static void check(const arrow::Status& status) {
+    if (!status.ok()) {
+        throw std::runtime_error("Arrow: " + status.ToString());
+    }
+}
+
+template <class T>
+static T unwrap(arrow::Result<T> result) {
+    check(result.status());
+    return std::move(result).ValueOrDie();
+}
+
+
+/**
+ * @brief Open the output file and write the schema
+ *
+ * @param filename Path of the output file
+ * @param parquet Write a Parquet file instead of an Arrow IPC stream
+ * @param row_group_size Number of records per row group / record batch
+ *
+ * @throw std::runtime_error
+ */
+ArrowResultWriter::ArrowResultWriter(const std::string& filename, bool parquet, size_t row_group_size) : ResultWriter(filename) {
+    this->parquet = parquet;
+    this->row_group_size = row_group_size;
+
+    auto dictionary_type = arrow::dictionary(arrow::int32(), arrow::utf8());
+    arrow::FieldVector fields = {
+        arrow::field("job.tag", arrow::utf8()),
+        arrow::field("job.workload", dictionary_type),
+        arrow::field("machine.name", dictionary_type)
+    };
+    for (const auto& name : value_columns) {
+        fields.push_back(arrow::field(name, arrow::float64()));
+    }
+    this->schema = arrow::schema(fields);
+    this->values.resize(value_columns.size());
+
+    try {
+        this->sink = unwrap(arrow::io::FileOutputStream::Open(filename));
+    } catch (std::runtime_error& e) {
+        throw std::runtime_error("Couldn't open output-file " + filename + " for dump! (" + e.what() + ")");
+    }
+    if (this->parquet) {
+        auto properties = parquet::WriterProperties::Builder().compression(parquet::Compression::SNAPPY)->build();
+        // Store the Arrow schema to restore the dictionary types when reading
+        auto arrow_properties = parquet::ArrowWriterProperties::Builder().store_schema()->build();
+        this->parquet_writer = unwrap(parquet::arrow::FileWriter::Open(
+            *this->schema, arrow::default_memory_pool(), this->sink, properties, arrow_properties
+        ));
+    } else {
+        auto options = arrow::ipc::IpcWriteOptions::Defaults();
+        // Only new dictionary entries are sent with each record batch
+        options.emit_dictionary_deltas = true;
+        this->ipc_writer = unwrap(arrow::ipc::MakeStreamWriter(this->sink, this->schema, options));
+    }
+}
+
+ArrowResultWriter::~ArrowResultWriter() {
+    try {
+        this->close();
+    } catch (std::exception& e) {
+        std::fprintf(stderr, "Exception while closing output-file %s: %s\n", this->filename.c_str(), e.what());
+    }
+}
+
+/**
+ * @brief Append a job record to the current row group
+ *
+ * @param record Information about the completed job
+ */
+void ArrowResultWriter::write(const JobRecord& record) {
+    check(this->job_tags.Append(record.job_tag));
+    check(this->workload_indices.Append(this->workloads.encode(record.workload)));
+    check(this->machine_indices.Append(this->machines.encode(record.machine_name)));
+    const double row[] = {
+        record.hitrate,
+        record.submit_time, record.start_time, record.end_time, record.queue_wait,
+        record.compute_time, record.io_stall_time, record.overlap_fraction,
+        record.infile_transfer_time, record.infile_size, record.infile_cached_size, record.infile_remote_size,
+        record.outfile_transfer_time, record.outfile_size
+    };
+    for (size_t i = 0; i < this->values.size(); i++) {
+        check(this->values[i].Append(row[i]));
+    }
+
+    if (static_cast<size_t>(this->job_tags.length()) >= this->row_group_size) {
+        this->writeRowGroup();
+    }
+}
+
+/**
+ * @brief Write out the last row group and close the file
+ *
+ * @throw std::runtime_error
+ */
+void ArrowResultWriter::close() {
+    if (this->closed) {
+        return;
+    }
+    this->closed = true;
+    if (this->job_tags.length() > 0) {
+        this->writeRowGroup();
+    }
+    if (this->parquet) {
+        check(this->parquet_writer->Close());
+    } else {
+        check(this->ipc_writer->Close());
+    }
+    check(this->sink->Close());
+}
+
+/**
+ * @brief Write all collected records as one row group / record batch
+ */
+void ArrowResultWriter::writeRowGroup() {
+    int64_t num_rows = this->job_tags.length();
+    auto dictionary_type = arrow::dictionary(arrow::int32(), arrow::utf8());
+
+    arrow::ArrayVector columns;
+    columns.push_back(unwrap(this->job_tags.Finish()));
+    columns.push_back(unwrap(arrow::DictionaryArray::FromArrays(
+        dictionary_type, unwrap(this->workload_indices.Finish()), this->workloads.finish()
+    )));
+    columns.push_back(unwrap(arrow::DictionaryArray::FromArrays(
+        dictionary_type, unwrap(this->machine_indices.Finish()), this->machines.finish()
+    )));
+    for (auto& builder : this->values) {
+        columns.push_back(unwrap(builder.Finish()));
+    }
+    auto batch = arrow::RecordBatch::Make(this->schema, num_rows, columns);
+
+    if (this->parquet) {
+        auto table = unwrap(arrow::Table::FromRecordBatches(this->schema, {batch}));
+        check(this->parquet_writer->WriteTable(*table, num_rows));
+    } else {
+        check(this->ipc_writer->WriteRecordBatch(*batch));
+    }
+}
+
+/**
+ * @brief Get the index of a string in the dictionary, adding it if it is new
+ */
+int32_t ArrowResultWriter::Dictionary::encode(const std::string& value) {
+    auto it = this->indices.find(value);
+    if (it != this->indices.end()) {
+        return it->second;
+    }
+    int32_t index = this->values.size();
+    this->indices.emplace(value, index);
+    this->values.push_back(value);
+    return index;
+}
+
+/**
+ * @brief Build the array of all dictionary entries so far.
+ * Earlier entries never change, so subsequent batches only extend the dictionary.
+ */
+std::shared_ptr<arrow::Array> ArrowResultWriter::Dictionary::finish() const {
+    arrow::StringBuilder builder;
+    check(builder.AppendValues(this->values));
+    return unwrap(builder.Finish());
+}
+
+#endif //DCSIM_WITH_ARROW
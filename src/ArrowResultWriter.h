@@ -0,0 +1,65 @@
+
+
+#ifndef S_ARROWRESULTWRITER_H
+#define S_ARROWRESULTWRITER_H
+
+#ifdef DCSIM_WITH_ARROW
+
+#include "ResultWriter.h"
+
+#include <unordered_map>
+#include <vector>
+
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/writer.h>
+#include <parquet/arrow/writer.h>
+
+/**
+ * @brief Writer of the job records into a typed columnar file,
+ * either in the Apache Arrow IPC streaming format or as Apache Parquet file.
+ * Records are collected column-wise and written out in row groups.
+ * Workload and host names are dictionary-encoded.
+ */
+class ArrowResultWriter : public ResultWriter {
+public:
+    ArrowResultWriter(const std::string& filename, bool parquet, size_t row_group_size = 65536);
+    ~ArrowResultWriter() override;
+
+    void write(const JobRecord& record) override;
+    void close() override;
+
+private:
+    /**
+     * @brief Dictionary of strings persistent over all row groups
+     */
+    struct Dictionary {
+        std::unordered_map<std::string, int32_t> indices;
+        std::vector<std::string> values;
+        int32_t encode(const std::string& value);
+        std::shared_ptr<arrow::Array> finish() const;
+    };
+
+    void writeRowGroup();
+
+    bool parquet;
+    size_t row_group_size;
+    bool closed = false;
+
+    std::shared_ptr<arrow::Schema> schema;
+    std::shared_ptr<arrow::io::FileOutputStream> sink;
+    std::shared_ptr<arrow::ipc::RecordBatchWriter> ipc_writer;
+    std::unique_ptr<parquet::arrow::FileWriter> parquet_writer;
+
+    Dictionary workloads;
+    Dictionary machines;
+
+    arrow::StringBuilder job_tags;
+    arrow::Int32Builder workload_indices;
+    arrow::Int32Builder machine_indices;
+    std::vector<arrow::DoubleBuilder> values;
+};
+
+#endif //DCSIM_WITH_ARROW
+
+#endif //S_ARROWRESULTWRITER_H
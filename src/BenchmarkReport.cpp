@@ -0,0 +1,108 @@
+
+
+#include "BenchmarkReport.h"
+
+#include <fstream>
+#include <stdexcept>
+
+#include <sys/resource.h>
+
+#include <nlohmann/json.hpp>
+
+
+BenchmarkReport::BenchmarkReport() {
+    this->start = Clock::now();
+    this->phase_start = this->start;
+}
+
+/**
+ * @brief Start timing a new phase, ending the current one
+ *
+ * @param name Name of the phase
+ */
+void BenchmarkReport::startPhase(const std::string& name) {
+    this->endPhase();
+    this->current_phase = name;
+    this->phase_start = Clock::now();
+}
+
+/**
+ * @brief End timing the current phase
+ */
+void BenchmarkReport::endPhase() {
+    if (this->current_phase.empty()) {
+        return;
+    }
+    double duration = std::chrono::duration<double>(Clock::now() - this->phase_start).count();
+    this->phases.push_back({this->current_phase, duration, getPeakRSS()});
+    this->current_phase.clear();
+}
+
+/**
+ * @brief Set a figure of the run, e.g. the number of simulated jobs
+ */
+void BenchmarkReport::set(const std::string& key, double value) {
+    this->values[key] = value;
+}
+
+/**
+ * @brief Wall time of a finished phase in seconds, 0 if it did not run
+ */
+double BenchmarkReport::getPhaseDuration(const std::string& name) const {
+    double duration = 0.;
+    for (const auto& phase : this->phases) {
+        if (phase.name == name) duration += phase.duration;
+    }
+    return duration;
+}
+
+/**
+ * @brief Peak resident set size of the process so far
+ *
+ * @return double, in bytes
+ */
+double BenchmarkReport::getPeakRSS() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0.;
+    }
+#ifdef __APPLE__
+    return static_cast<double>(usage.ru_maxrss);
+#else
+    return static_cast<double>(usage.ru_maxrss) * 1024.;
+#endif
+}
+
+/**
+ * @brief End the current phase and write the report as JSON file
+ *
+ * @param filename Path of the report
+ *
+ * @throw std::runtime_error
+ */
+void BenchmarkReport::write(const std::string& filename) {
+    this->endPhase();
+    nlohmann::json report;
+    report["phases"] = nlohmann::json::array();
+    for (const auto& phase : this->phases) {
+        report["phases"].push_back({
+            {"name", phase.name},
+            {"walltime", phase.duration},
+            {"peak_rss", phase.peak_rss}
+        });
+    }
+    report["walltime"] = std::chrono::duration<double>(Clock::now() - this->start).count();
+    report["peak_rss"] = getPeakRSS();
+    for (const auto& [key, value] : this->values) {
+        report[key] = value;
+    }
+
+    std::ofstream file(filename, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Couldn't open benchmark report " + filename + " for dump!");
+    }
+    file << report.dump(4) << std::endl;
+    if (!file.good()) {
+        throw std::runtime_error("Failed writing benchmark report " + filename + "!");
+    }
+}
@@ -0,0 +1,46 @@
+
+
+#ifndef S_BENCHMARKREPORT_H
+#define S_BENCHMARKREPORT_H
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Report of the simulator's own performance in a run:
+ * wall time of the consecutive phases, peak resident memory and throughput figures,
+ * written as machine-readable JSON.
+ */
+class BenchmarkReport {
+public:
+    BenchmarkReport();
+
+    void startPhase(const std::string& name);
+    void endPhase();
+
+    void set(const std::string& key, double value);
+    double getPhaseDuration(const std::string& name) const;
+
+    void write(const std::string& filename);
+
+    static double getPeakRSS();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Phase {
+        std::string name;
+        double duration;
+        double peak_rss;
+    };
+
+    std::vector<Phase> phases;
+    std::string current_phase;
+    Clock::time_point phase_start;
+    Clock::time_point start;
+    std::map<std::string, double> values;
+};
+
+#endif //S_BENCHMARKREPORT_H
@@ -0,0 +1,96 @@
+
+
+#include "CacheMonitor.h"
+#include "SimpleSimulator.h"
+
+#include <fstream>
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(cache_monitor, "Log category for CacheMonitor");
+
+
+/**
+ * @brief Construct the cache monitor
+ *
+ * @param cache_storage_services Caches to monitor
+ * @param hostname Host running the monitor
+ * @param interval Sampling interval in simulated seconds
+ * @param filename Path of the CSV file holding the time series
+ *
+ * @throw std::invalid_argument
+ */
+CacheMonitor::CacheMonitor(
+        const std::set<std::shared_ptr<wrench::StorageService>>& cache_storage_services,
+        const std::string& hostname,
+        double interval,
+        const std::string& filename) : wrench::ExecutionController(
+        hostname,
+        "cache-monitor") {
+    if (interval <= 0.) {
+        throw std::invalid_argument("CacheMonitor(): The sampling interval has to be positive!");
+    }
+    this->cache_storage_services.assign(cache_storage_services.begin(), cache_storage_services.end());
+    this->previous_counters.resize(this->cache_storage_services.size());
+    this->interval = interval;
+    this->filename = filename;
+}
+
+/**
+ * @brief main method of the CacheMonitor daemon
+ *
+ * @return 0 on completion
+ */
+int CacheMonitor::main() {
+    WRENCH_INFO("Monitoring %lu caches every %.2f s", this->cache_storage_services.size(), this->interval);
+    this->sample();
+    while (SimpleSimulator::active_execution_controllers > 0) {
+        wrench::Simulation::sleep(this->interval);
+        this->sample();
+    }
+    WRENCH_INFO("CacheMonitor on host %s terminating after %lu samples", this->getHostname().c_str(), this->samples.size());
+    return 0;
+}
+
+/**
+ * @brief Take a sample of all caches
+ */
+void CacheMonitor::sample() {
+    double now = wrench::Simulation::getCurrentSimulatedDate();
+    for (size_t i = 0; i < this->cache_storage_services.size(); i++) {
+        const auto& file_list = SimpleSimulator::global_file_map[this->cache_storage_services[i]];
+        const auto& counters = file_list.getCounters();
+        auto& previous = this->previous_counters[i];
+        this->samples.push_back({
+            now, i,
+            file_list.getUsedBytes(), file_list.getNumFiles(),
+            counters.hits - previous.hits, counters.misses - previous.misses,
+            counters.evicted_bytes - previous.evicted_bytes, counters.filled_bytes - previous.filled_bytes
+        });
+        previous = counters;
+    }
+}
+
+/**
+ * @brief Write the sampled time series into the CSV file
+ *
+ * @throw std::runtime_error
+ */
+void CacheMonitor::write() {
+    std::ofstream file(this->filename, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Couldn't open cache monitor file " + this->filename + " for dump!");
+    }
+    file << "time, cache.host, cache.usedbytes, cache.nfiles, cache.hits, cache.misses, cache.evictedbytes, cache.filledbytes\n";
+    for (const auto& s : this->samples) {
+        file << std::to_string(s.time) << ", "
+             << this->cache_storage_services[s.cache]->getHostname() << ", "
+             << std::to_string(s.used_bytes) << ", "
+             << s.num_files << ", "
+             << s.hits << ", "
+             << s.misses << ", "
+             << std::to_string(s.evicted_bytes) << ", "
+             << std::to_string(s.filled_bytes) << "\n";
+    }
+    if (!file.good()) {
+        throw std::runtime_error("Failed writing cache monitor file " + this->filename + "!");
+    }
+}
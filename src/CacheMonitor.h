@@ -0,0 +1,52 @@
+
+
+#ifndef S_CACHEMONITOR_H
+#define S_CACHEMONITOR_H
+
+#include <wrench-dev.h>
+
+#include "LRU_FileList.h"
+
+/**
+ * @brief Actor periodically sampling the state of all caches in simulated time:
+ * occupancy and number of files, as well as hits, misses, evicted and filled bytes
+ * since the previous sample. The time series is written as CSV file at the end.
+ * The monitor stops once all workload execution controllers have finished.
+ */
+class CacheMonitor : public wrench::ExecutionController {
+public:
+    CacheMonitor(
+        const std::set<std::shared_ptr<wrench::StorageService>>& cache_storage_services,
+        const std::string& hostname,
+        double interval,
+        const std::string& filename
+    );
+
+    void write();
+
+private:
+    int main() override;
+    void sample();
+
+    struct Sample {
+        double time;
+        size_t cache;
+        double used_bytes;
+        size_t num_files;
+        size_t hits;
+        size_t misses;
+        double evicted_bytes;
+        double filled_bytes;
+    };
+
+    std::vector<std::shared_ptr<wrench::StorageService>> cache_storage_services;
+    /** @brief counters of every cache at the previous sample **/
+    std::vector<LRU_FileList::Counters> previous_counters;
+    std::vector<Sample> samples;
+
+    /** @brief sampling interval in simulated seconds **/
+    double interval;
+    std::string filename;
+};
+
+#endif //S_CACHEMONITOR_H
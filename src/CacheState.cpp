@@ -0,0 +1,237 @@
+
+
+#include "CacheState.h"
+#include "SimpleSimulator.h"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+#include <unordered_set>
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(cache_state, "Log category for CacheState");
+
+
+static const uint32_t endianness_tag = 0x01020304;
+
+/**
+ * @brief Round a byte offset up to the next multiple of 8
+ */
+static uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~uint64_t(7);
+}
+
+/**
+ * @brief Check whether a table of records lies within the file and is 8-byte aligned
+ */
+static bool tableInFile(uint64_t offset, uint64_t count, size_t record_size, size_t file_size) {
+    return offset % 8 == 0 && offset <= file_size && count <= (file_size - offset) / record_size;
+}
+
+/**
+ * @brief Check whether a slice of a table lies within the table
+ */
+static bool sliceInTable(uint64_t first, uint64_t count, uint64_t table_size) {
+    return first <= table_size && count <= table_size - first;
+}
+
+/**
+ * @brief Write the files held by the given caches, in their LRU order, into a binary cache-state file
+ *
+ * @param caches Cache storage services, whose file collections to store
+ * @param path Path of the cache-state file
+ *
+ * @throw std::runtime_error
+ */
+void CacheState::save(const std::set<std::shared_ptr<wrench::StorageService>>& caches, const std::string& path) {
+    std::vector<CacheRecord> cache_records;
+    std::vector<FileRecord> file_records;
+    std::vector<uint64_t> entries;
+    std::string strings;
+
+    // Catalog of unique files, files held by several caches are stored once
+    std::unordered_map<const wrench::DataFile*, uint64_t> file_indices;
+    auto file_index = [&](const wrench::DataFile* file) {
+        auto it = file_indices.find(file);
+        if (it != file_indices.end()) {
+            return it->second;
+        }
+        uint64_t index = file_records.size();
+        file_records.push_back({strings.size(), file->getID().size(), file->getSize()});
+        strings += file->getID();
+        file_indices[file] = index;
+        return index;
+    };
+
+    cache_records.reserve(caches.size());
+    for (const auto& cache : caches) {
+        const auto& file_list = SimpleSimulator::global_file_map[cache];
+        CacheRecord record = {};
+        record.host_offset = strings.size();
+        record.host_length = cache->getHostname().size();
+        record.first_entry = entries.size();
+        record.used_bytes = file_list.getUsedBytes();
+        strings += cache->getHostname();
+        for (const auto file : file_list.getFiles()) {
+            entries.push_back(file_index(file));
+        }
+        record.num_entries = entries.size() - record.first_entry;
+        cache_records.push_back(record);
+    }
+
+    Header header = {};
+    std::memcpy(header.magic, CacheState::magic, sizeof(header.magic));
+    header.version = CacheState::version;
+    header.endianness = endianness_tag;
+    header.num_caches = cache_records.size();
+    header.num_files = file_records.size();
+    header.num_entries = entries.size();
+    header.num_string_bytes = strings.size();
+    header.caches_offset = align8(sizeof(Header));
+    header.files_offset = align8(header.caches_offset + cache_records.size() * sizeof(CacheRecord));
+    header.entries_offset = align8(header.files_offset + file_records.size() * sizeof(FileRecord));
+    header.strings_offset = align8(header.entries_offset + entries.size() * sizeof(uint64_t));
+
+    std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error("Couldn't open cache-state file " + path + " for writing!");
+    }
+    auto write_at = [&out](uint64_t offset, const void* data, size_t size) {
+        static const char zeros[8] = {};
+        uint64_t position = out.tellp();
+        out.write(zeros, offset - position);
+        out.write(static_cast<const char*>(data), size);
+    };
+    write_at(0, &header, sizeof(Header));
+    write_at(header.caches_offset, cache_records.data(), cache_records.size() * sizeof(CacheRecord));
+    write_at(header.files_offset, file_records.data(), file_records.size() * sizeof(FileRecord));
+    write_at(header.entries_offset, entries.data(), entries.size() * sizeof(uint64_t));
+    write_at(header.strings_offset, strings.data(), strings.size());
+    if (!out.good()) {
+        throw std::runtime_error("Failed writing cache-state file " + path + "!");
+    }
+    WRENCH_INFO("Wrote %lu cached files of %lu caches to cache-state file %s", entries.size(), cache_records.size(), path.c_str());
+}
+
+/**
+ * @brief Prepopulate the caches with the files stored in a binary cache-state file
+ * and restore their LRU order. Must be called before the simulation is launched.
+ * Files unknown to the simulation are added with their stored size, so they occupy
+ * cache space like in the run the state was saved from. When a cache has not enough
+ * space, only its most recently used files are restored. The file is validated before
+ * any file is added, and a warning is issued when the restored bytes of a cache differ
+ * from the saved ones.
+ *
+ * @param path Path of the cache-state file
+ * @param caches Cache storage services to populate, matched by their host's name
+ * @param simulation Simulation to stage the files in
+ *
+ * @throw std::runtime_error
+ */
+void CacheState::load(const std::string& path, const std::set<std::shared_ptr<wrench::StorageService>>& caches, std::shared_ptr<wrench::Simulation> simulation) {
+    std::ifstream in(path, std::ios::in | std::ios::binary);
+    if (!in.is_open()) {
+        throw std::runtime_error("Couldn't open cache-state file " + path + "!");
+    }
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (content.size() < sizeof(Header)) {
+        throw std::runtime_error("Cache-state file " + path + " is truncated!");
+    }
+    const char* base = content.data();
+    Header header;
+    std::memcpy(&header, base, sizeof(Header));
+    if (std::memcmp(header.magic, CacheState::magic, sizeof(header.magic)) != 0 ||
+        header.version != CacheState::version || header.endianness != endianness_tag) {
+        throw std::runtime_error("File " + path + " is no compatible cache-state file!");
+    }
+    if (!tableInFile(header.caches_offset, header.num_caches, sizeof(CacheRecord), content.size()) ||
+        !tableInFile(header.files_offset, header.num_files, sizeof(FileRecord), content.size()) ||
+        !tableInFile(header.entries_offset, header.num_entries, sizeof(uint64_t), content.size()) ||
+        !tableInFile(header.strings_offset, header.num_string_bytes, 1, content.size())) {
+        throw std::runtime_error("Cache-state file " + path + " is truncated!");
+    }
+    // The string buffer's allocation is suitably aligned for the 8-byte aligned tables
+    auto cache_records = reinterpret_cast<const CacheRecord*>(base + header.caches_offset);
+    auto file_records = reinterpret_cast<const FileRecord*>(base + header.files_offset);
+    auto entries = reinterpret_cast<const uint64_t*>(base + header.entries_offset);
+    const char* strings = base + header.strings_offset;
+
+    // Validate all references before any file is added to the simulation
+    auto corrupt = std::runtime_error("Cache-state file " + path + " is corrupt!");
+    for (uint64_t c = 0; c < header.num_caches; c++) {
+        if (!sliceInTable(cache_records[c].host_offset, cache_records[c].host_length, header.num_string_bytes) ||
+            !sliceInTable(cache_records[c].first_entry, cache_records[c].num_entries, header.num_entries)) {
+            throw corrupt;
+        }
+    }
+    for (uint64_t i = 0; i < header.num_files; i++) {
+        if (!sliceInTable(file_records[i].id_offset, file_records[i].id_length, header.num_string_bytes)) {
+            throw corrupt;
+        }
+    }
+    for (uint64_t e = 0; e < header.num_entries; e++) {
+        if (entries[e] >= header.num_files) {
+            throw corrupt;
+        }
+    }
+
+    std::map<std::string, std::shared_ptr<wrench::StorageService>> caches_by_host;
+    for (const auto& cache : caches) {
+        caches_by_host[cache->getHostname()] = cache;
+    }
+
+    // Resolve the catalog to the simulation's files, adding the missing ones
+    auto& file_map = wrench::Simulation::getFileMap();
+    std::vector<std::shared_ptr<wrench::DataFile>> files;
+    files.reserve(header.num_files);
+    for (uint64_t i = 0; i < header.num_files; i++) {
+        const auto& record = file_records[i];
+        std::string id(strings + record.id_offset, record.id_length);
+        auto it = file_map.find(id);
+        files.push_back(it != file_map.end() ? it->second : wrench::Simulation::addFile(id, record.size));
+    }
+
+    size_t num_restored = 0;
+    for (uint64_t c = 0; c < header.num_caches; c++) {
+        const auto& record = cache_records[c];
+        std::string host(strings + record.host_offset, record.host_length);
+        auto cache_it = caches_by_host.find(host);
+        if (cache_it == caches_by_host.end()) {
+            WRENCH_WARN("No cache on host %s, ignoring its %lu files in cache-state file %s", host.c_str(), record.num_entries, path.c_str());
+            continue;
+        }
+        const auto& cache = cache_it->second;
+        auto& file_list = SimpleSimulator::global_file_map[cache];
+
+        // Stage from most to least recently used, so a smaller cache keeps the hottest files
+        uint64_t num_staged = 0;
+        for (; num_staged < record.num_entries; num_staged++) {
+            const auto& f = files[entries[record.first_entry + num_staged]];
+            if (file_list.hasFile(f)) {
+                continue;
+            }
+            try {
+                simulation->stageFile(wrench::FileLocation::LOCATION(cache, f));
+            } catch (std::exception& e) {
+                WRENCH_WARN("Cache on host %s is full after restoring %lu of %lu files: %s", host.c_str(), num_staged, record.num_entries, e.what());
+                break;
+            }
+        }
+        // Touch in reverse, so the most recently used file ends up at the front of the LRU list
+        for (uint64_t i = num_staged; i > 0; i--) {
+            file_list.touchFile(files[entries[record.first_entry + i - 1]].get());
+        }
+        // Count every restored file once, even if it is listed repeatedly
+        std::unordered_set<uint64_t> restored_files(entries + record.first_entry, entries + record.first_entry + num_staged);
+        double restored_bytes = 0.;
+        for (const auto i : restored_files) {
+            restored_bytes += files[i]->getSize();
+        }
+        if (std::abs(restored_bytes - record.used_bytes) > 1.) {
+            WRENCH_WARN("Restored %.0f bytes on cache on host %s instead of the saved %.0f bytes", restored_bytes, host.c_str(), record.used_bytes);
+        }
+        num_restored += num_staged;
+    }
+    WRENCH_INFO("Restored %lu cached files of %lu caches from cache-state file %s", num_restored, header.num_caches, path.c_str());
+}
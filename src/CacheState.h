@@ -0,0 +1,56 @@
+
+
+#ifndef S_CACHESTATE_H
+#define S_CACHESTATE_H
+
+#include <wrench-dev.h>
+
+#include <cstdint>
+#include <set>
+
+/**
+ * @brief Compact binary snapshot of the caches' contents and their LRU order,
+ * to start simulations from warm caches instead of empty or hitrate-staged ones.
+ *
+ * The layout follows the workload snapshot: fixed-size, 8-byte aligned record tables
+ * addressed via offsets in the header. Caches are identified by their host's name,
+ * files by their ID, and every cache lists its files from most to least recently used.
+ */
+class CacheState {
+public:
+    static void save(const std::set<std::shared_ptr<wrench::StorageService>>& caches, const std::string& path);
+    static void load(const std::string& path, const std::set<std::shared_ptr<wrench::StorageService>>& caches, std::shared_ptr<wrench::Simulation> simulation);
+
+    static constexpr const char* magic = "DCSIMCS";
+    static constexpr uint32_t version = 1;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t endianness;
+        uint64_t num_caches;
+        uint64_t num_files;
+        uint64_t num_entries;
+        uint64_t num_string_bytes;
+        uint64_t caches_offset;
+        uint64_t files_offset;
+        uint64_t entries_offset;
+        uint64_t strings_offset;
+    };
+
+    struct CacheRecord {
+        uint64_t host_offset;
+        uint64_t host_length;
+        uint64_t first_entry;
+        uint64_t num_entries;
+        double used_bytes;
+    };
+
+    struct FileRecord {
+        uint64_t id_offset;
+        uint64_t id_length;
+        double size;
+    };
+};
+
+#endif //S_CACHESTATE_H
@@ -0,0 +1,190 @@
+
+
+#include "ConvergenceMonitor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+
+/**
+ * @brief Construct the convergence monitor
+ *
+ * @param warmup Simulated time at the start, whose completed jobs are excluded from the statistics
+ * @param window Duration of the windows in simulated seconds
+ * @param num_windows Number of consecutive windows, which have to be stable
+ * @param tolerance Maximal spread of the windows' metrics relative to their mean
+ * @param detect_steady_state Switch to stop the simulation once the steady state is reached
+ * @param max_sim_time Simulated time after which the simulation is stopped, infinity for no limit
+ * @param max_completed_jobs Number of completed jobs after which the simulation is stopped, 0 for no limit
+ *
+ * @throw std::invalid_argument
+ */
+ConvergenceMonitor::ConvergenceMonitor(double warmup, double window, size_t num_windows, double tolerance, bool detect_steady_state,
+                                       double max_sim_time, size_t max_completed_jobs) {
+    if (warmup < 0.) {
+        throw std::invalid_argument("ConvergenceMonitor(): The warm-up period must not be negative!");
+    }
+    if (window <= 0.) {
+        throw std::invalid_argument("ConvergenceMonitor(): The window duration has to be positive!");
+    }
+    if (num_windows < 2) {
+        throw std::invalid_argument("ConvergenceMonitor(): At least two windows are needed to detect a steady state!");
+    }
+    if (tolerance < 0.) {
+        throw std::invalid_argument("ConvergenceMonitor(): The tolerance must not be negative!");
+    }
+    if (max_sim_time <= 0.) {
+        throw std::invalid_argument("ConvergenceMonitor(): The maximal simulated time has to be positive!");
+    }
+    this->warmup = warmup;
+    this->window = window;
+    this->num_windows = num_windows;
+    this->tolerance = tolerance;
+    this->detect_steady_state = detect_steady_state;
+    this->max_sim_time = max_sim_time;
+    this->max_completed_jobs = max_completed_jobs;
+}
+
+/**
+ * @brief Account a completed job
+ *
+ * @param end Simulated time the job completed at
+ * @param infile_size Bytes of input-files the job read
+ * @param cached_infile_size Bytes of input-files served by caches
+ */
+void ConvergenceMonitor::addJob(double end, double infile_size, double cached_infile_size) {
+    this->update(end);
+    this->completed_jobs++;
+    if (end >= this->warmup) {
+        this->current.jobs++;
+        this->current.infile_bytes += infile_size;
+        this->current.cached_bytes += cached_infile_size;
+    }
+    if (this->max_completed_jobs > 0 && this->completed_jobs >= this->max_completed_jobs && this->stop_reason.empty()) {
+        this->stop_reason = "reached " + std::to_string(this->completed_jobs) + " completed jobs";
+    }
+}
+
+/**
+ * @brief Advance the monitor to the current simulated time:
+ * close all windows ended so far and check the stop conditions
+ *
+ * @param now Current simulated time
+ */
+void ConvergenceMonitor::update(double now) {
+    this->now = std::max(this->now, now);
+    while (this->now >= this->windowStart(this->windows.size() + 1)) {
+        this->windows.push_back(this->current);
+        this->current = Window();
+        if (this->detect_steady_state && this->stop_reason.empty() && this->isStable()) {
+            this->stop_reason = "reached steady state after " + std::to_string(this->windowStart(this->windows.size())) + " s";
+        }
+    }
+    if (this->now >= this->max_sim_time && this->stop_reason.empty()) {
+        this->stop_reason = "reached maximal simulated time of " + std::to_string(this->max_sim_time) + " s";
+    }
+}
+
+/**
+ * @brief Next simulated time, at which the stop conditions have to be checked
+ * independent of completing jobs, infinity if there is none
+ */
+double ConvergenceMonitor::nextCheck() const {
+    double next = this->max_sim_time;
+    if (this->detect_steady_state) {
+        next = std::min(next, this->windowStart(this->windows.size() + 1));
+    }
+    return next;
+}
+
+/**
+ * @brief Start of a window in simulated time
+ */
+double ConvergenceMonitor::windowStart(size_t window) const {
+    return this->warmup + window * this->window;
+}
+
+/**
+ * @brief Check whether throughput and byte hitrate of the last windows are stable within the tolerance.
+ * Windows without any completed job never count as stable.
+ */
+bool ConvergenceMonitor::isStable() const {
+    if (this->windows.size() < this->num_windows) {
+        return false;
+    }
+    auto stable = [this](auto metric) {
+        double min = std::numeric_limits<double>::infinity();
+        double max = -std::numeric_limits<double>::infinity();
+        double sum = 0.;
+        for (size_t w = this->windows.size() - this->num_windows; w < this->windows.size(); w++) {
+            double value = metric(this->windows[w]);
+            min = std::min(min, value);
+            max = std::max(max, value);
+            sum += value;
+        }
+        return max - min <= this->tolerance * std::abs(sum / this->num_windows);
+    };
+    for (size_t w = this->windows.size() - this->num_windows; w < this->windows.size(); w++) {
+        if (this->windows[w].jobs == 0) {
+            return false;
+        }
+    }
+    return stable([this](const Window& w) { return w.throughput(this->window); }) &&
+           stable([](const Window& w) { return w.byteHitrate(); });
+}
+
+/**
+ * @brief Print the stop reason and the job throughput and byte hitrate after the warm-up
+ *
+ * @param out Stream to print to
+ */
+void ConvergenceMonitor::print(std::ostream& out) const {
+    Window total = this->current;
+    for (const auto& w : this->windows) {
+        total.jobs += w.jobs;
+        total.infile_bytes += w.infile_bytes;
+        total.cached_bytes += w.cached_bytes;
+    }
+    out << "Simulation " << (this->shouldStop() ? "stopped early, " + this->stop_reason : "ran to completion")
+        << " with " << this->completed_jobs << " completed jobs" << std::endl;
+    if (this->now > this->warmup) {
+        out << "\tafter warm-up of " << this->warmup << " s: "
+            << total.throughput(this->now - this->warmup) << " jobs/s, byte hitrate " << total.byteHitrate()
+            << " over " << this->windows.size() << " complete windows of " << this->window << " s" << std::endl;
+    }
+}
+
+/**
+ * @brief Write the windows' job throughput and byte hitrate as time series into a CSV file,
+ * including the last, incomplete window
+ *
+ * @param filename Path of the CSV file
+ *
+ * @throw std::runtime_error
+ */
+void ConvergenceMonitor::write(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Couldn't open steady-state report " + filename + " for dump!");
+    }
+    file << "window.start, window.end, window.jobs, window.throughput, window.bytehitrate\n";
+    auto write_window = [&file](const Window& w, double start, double end) {
+        file << std::to_string(start) << ", "
+             << std::to_string(end) << ", "
+             << w.jobs << ", "
+             << std::to_string(w.throughput(end - start)) << ", "
+             << std::to_string(w.byteHitrate()) << "\n";
+    };
+    for (size_t w = 0; w < this->windows.size(); w++) {
+        write_window(this->windows[w], this->windowStart(w), this->windowStart(w + 1));
+    }
+    double start = this->windowStart(this->windows.size());
+    if (this->now > start) {
+        write_window(this->current, start, this->now);
+    }
+    if (!file.good()) {
+        throw std::runtime_error("Failed writing steady-state report " + filename + "!");
+    }
+}
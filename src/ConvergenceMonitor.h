@@ -0,0 +1,76 @@
+
+
+#ifndef S_CONVERGENCEMONITOR_H
+#define S_CONVERGENCEMONITOR_H
+
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Online detection of the steady state and of the limits, at which the simulation is terminated early.
+ * Completed jobs are accounted into consecutive windows of fixed simulated duration, starting after
+ * an optional warm-up period. The steady state is reached once the job throughput and the byte hitrate
+ * of the last windows each stay within a relative tolerance of their mean.
+ * Independently, the simulation can be limited in simulated time and number of completed jobs.
+ */
+class ConvergenceMonitor {
+public:
+    ConvergenceMonitor(double warmup, double window, size_t num_windows, double tolerance, bool detect_steady_state,
+                       double max_sim_time, size_t max_completed_jobs);
+
+    void addJob(double end, double infile_size, double cached_infile_size);
+    void update(double now);
+
+    /**
+     * @brief Whether the simulation shall stop, checked by the execution controllers
+     */
+    bool shouldStop() const {
+        return !this->stop_reason.empty();
+    }
+
+    const std::string& getStopReason() const {
+        return this->stop_reason;
+    }
+
+    double nextCheck() const;
+
+    void print(std::ostream& out) const;
+    void write(const std::string& filename) const;
+
+private:
+    /**
+     * @brief Jobs completed within a window
+     */
+    struct Window {
+        size_t jobs = 0;
+        double infile_bytes = 0.;
+        double cached_bytes = 0.;
+        double throughput(double duration) const { return this->jobs / duration; }
+        double byteHitrate() const { return this->infile_bytes > 0. ? this->cached_bytes / this->infile_bytes : 0.; }
+    };
+
+    bool isStable() const;
+    double windowStart(size_t window) const;
+
+    double warmup;
+    double window;
+    size_t num_windows;
+    double tolerance;
+    bool detect_steady_state;
+    double max_sim_time;
+    size_t max_completed_jobs;
+
+    /** @brief closed windows since the end of the warm-up **/
+    std::vector<Window> windows;
+    /** @brief window currently being filled **/
+    Window current;
+    /** @brief jobs completed in total, including the warm-up **/
+    size_t completed_jobs = 0;
+    /** @brief simulated time of the last update **/
+    double now = 0.;
+    std::string stop_reason;
+};
+
+#endif //S_CONVERGENCEMONITOR_H
@@ -0,0 +1,153 @@
+
+
+#include "DryRunEstimator.h"
+#include "ActivityAccounting.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_set>
+
+
+/**
+ * @brief Load the coefficients of the cost model from a JSON file,
+ * coefficients missing in the file keep their default value
+ *
+ * @param filename Path of the JSON file
+ * @return DryRunEstimator::CostModel
+ *
+ * @throw std::runtime_error
+ */
+DryRunEstimator::CostModel DryRunEstimator::CostModel::load(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("File " + filename + " could not be opened!");
+    }
+    nlohmann::json json = nlohmann::json::parse(file);
+    CostModel model;
+    model.base_walltime = json.value("base_walltime", model.base_walltime);
+    model.walltime_per_job = json.value("walltime_per_job", model.walltime_per_job);
+    model.walltime_per_activity = json.value("walltime_per_activity", model.walltime_per_activity);
+    model.walltime_per_message = json.value("walltime_per_message", model.walltime_per_message);
+    model.base_memory = json.value("base_memory", model.base_memory);
+    model.memory_per_job = json.value("memory_per_job", model.memory_per_job);
+    model.memory_per_file = json.value("memory_per_file", model.memory_per_file);
+    model.memory_per_file_location = json.value("memory_per_file_location", model.memory_per_file_location);
+    return model;
+}
+
+nlohmann::json DryRunEstimator::CostModel::toJSON() const {
+    return {
+        {"base_walltime", this->base_walltime},
+        {"walltime_per_job", this->walltime_per_job},
+        {"walltime_per_activity", this->walltime_per_activity},
+        {"walltime_per_message", this->walltime_per_message},
+        {"base_memory", this->base_memory},
+        {"memory_per_job", this->memory_per_job},
+        {"memory_per_file", this->memory_per_file},
+        {"memory_per_file_location", this->memory_per_file_location}
+    };
+}
+
+nlohmann::json DryRunEstimator::Estimate::toJSON() const {
+    return {
+        {"jobs", this->jobs},
+        {"files", this->files},
+        {"file_locations", this->file_locations},
+        {"blocks", this->blocks},
+        {"activities", this->activities},
+        {"messages", this->messages},
+        {"walltime", this->walltime},
+        {"peak_memory", this->peak_memory}
+    };
+}
+
+/**
+ * @brief Count jobs, files, staged file locations, streamed blocks, activities and storage messages
+ * the simulation of the workloads would create, following the staging, duplication and computations,
+ * and predict its wall time and peak memory with the cost model.
+ * Evictions depend on the simulated execution and are not included.
+ *
+ * @param workloads Generated workloads
+ * @param duplications Number of replicas of every job
+ * @param num_grid_storages Number of GRID storages the input-files are staged on
+ * @param num_caches Number of caches the input-files are staged on according to the hitrate
+ * @param hitrate Initial share of the input-data staged on the caches
+ * @param origin_storage Switch for GRID storages holding all files implicitly without staging
+ * @param block_size Block size of the streamed input-files in bytes
+ * @param buffer_size Buffer size of the storage services in bytes
+ * @param model Cost model to predict the resource needs
+ * @return DryRunEstimator::Estimate
+ */
+DryRunEstimator::Estimate DryRunEstimator::estimate(
+    const std::vector<Workload>& workloads, size_t duplications,
+    size_t num_grid_storages, size_t num_caches,
+    double hitrate, bool origin_storage,
+    double block_size, double buffer_size,
+    const CostModel& model
+) {
+    Estimate estimate;
+    std::unordered_set<const wrench::DataFile*> infiles;
+    for (const auto& workload : workloads) {
+        for (const auto& job_spec : workload.job_batch) {
+            // Activities of a single replica of the job
+            size_t job_activities = 0;
+            size_t job_messages = 0;
+            size_t job_blocks = 0;
+            double infile_size = 0.;
+            for (const auto& f : *job_spec.infiles) {
+                infiles.insert(f.get());
+                infile_size += f->getSize();
+            }
+            double cached_size = 0.;
+            for (const auto& f : *job_spec.infiles) {
+                if (!origin_storage) {
+                    estimate.file_locations += num_grid_storages;
+                }
+                if (cached_size < hitrate * infile_size) {
+                    estimate.file_locations += num_caches;
+                    cached_size += f->getSize();
+                }
+                if (workload.workload_type == WorkloadType::Streaming) {
+                    size_t num_blocks = static_cast<size_t>(std::ceil(f->getSize() / block_size));
+                    job_blocks += num_blocks;
+                    // every block is read and computed
+                    job_activities += 2 * num_blocks;
+                    double remaining = f->getSize();
+                    for (size_t b = 0; b < num_blocks; b++, remaining -= block_size) {
+                        job_messages += ActivityCounters::messagesPerTransfer(std::min(block_size, remaining), buffer_size);
+                    }
+                } else if (workload.workload_type == WorkloadType::Copy) {
+                    job_blocks++;
+                    job_activities++;
+                    job_messages += ActivityCounters::messagesPerTransfer(f->getSize(), buffer_size);
+                }
+            }
+            // the computation of copy and calculation jobs, and the output file write
+            if (workload.workload_type != WorkloadType::Streaming) {
+                job_activities++;
+            }
+            job_activities++;
+            job_messages += ActivityCounters::messagesPerTransfer(job_spec.outfile->getSize(), buffer_size);
+
+            estimate.jobs += duplications;
+            estimate.blocks += duplications * job_blocks;
+            estimate.activities += duplications * job_activities;
+            estimate.messages += duplications * job_messages;
+            // every replica writes its own output file
+            estimate.files += duplications;
+        }
+    }
+    estimate.files += infiles.size();
+
+    estimate.walltime = model.base_walltime
+        + model.walltime_per_job * estimate.jobs
+        + model.walltime_per_activity * estimate.activities
+        + model.walltime_per_message * estimate.messages;
+    estimate.peak_memory = model.base_memory
+        + model.memory_per_job * estimate.jobs
+        + model.memory_per_file * estimate.files
+        + model.memory_per_file_location * estimate.file_locations;
+    return estimate;
+}
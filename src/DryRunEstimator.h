@@ -0,0 +1,60 @@
+
+
+#ifndef S_DRYRUNESTIMATOR_H
+#define S_DRYRUNESTIMATOR_H
+
+#include "Workload.h"
+
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Estimate of the size of a simulation and of the wall time and peak memory needed to run it,
+ * derived from the generated workloads and the platform without launching the simulation.
+ */
+class DryRunEstimator {
+public:
+    /**
+     * @brief Linear cost model of the simulator, calibrated with tools/calibrate_cost_model.py
+     */
+    struct CostModel {
+        /** @brief wall time in seconds **/
+        double base_walltime = 1.;
+        double walltime_per_job = 2.e-4;
+        double walltime_per_activity = 5.e-5;
+        double walltime_per_message = 1.e-5;
+        /** @brief memory in bytes **/
+        double base_memory = 100.e6;
+        double memory_per_job = 20.e3;
+        double memory_per_file = 1.e3;
+        double memory_per_file_location = 500.;
+
+        static CostModel load(const std::string& filename);
+        nlohmann::json toJSON() const;
+    };
+
+    /**
+     * @brief Counts of the simulation's entities and activities and the predicted resource needs
+     */
+    struct Estimate {
+        size_t jobs = 0;
+        size_t files = 0;
+        size_t file_locations = 0;
+        size_t blocks = 0;
+        size_t activities = 0;
+        size_t messages = 0;
+        double walltime = 0.;
+        double peak_memory = 0.;
+
+        nlohmann::json toJSON() const;
+    };
+
+    static Estimate estimate(
+        const std::vector<Workload>& workloads, size_t duplications,
+        size_t num_grid_storages, size_t num_caches,
+        double hitrate, bool origin_storage,
+        double block_size, double buffer_size,
+        const CostModel& model
+    );
+};
+
+#endif //S_DRYRUNESTIMATOR_H
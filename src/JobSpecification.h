@@ -7,6 +7,46 @@
 
 #include "util/Utils.h"
 
+/** @brief Collection of files, shared read-only between a job and its replicas */
+using FileList = std::vector<std::shared_ptr<wrench::DataFile>>;
+
+/**
+ * @brief Identity of a workload shared by all of its jobs
+ * 
+ */
+struct WorkloadTag {
+    // name of the workload, empty for the workload configured via command line
+    std::string name;
+    // number of unique jobs in the workload
+    size_t num_jobs;
+};
+
+/**
+ * @brief Structured job identifier (workload, index, replica),
+ * which is only formatted into a string when needed for output
+ * 
+ */
+struct JobID {
+    std::shared_ptr<const WorkloadTag> workload;
+    // index of the job within its workload
+    size_t index = 0;
+    // replica of the job created by workload duplication, 0 for the original
+    size_t replica = 0;
+
+    /**
+     * @brief Job tag unique within the simulation, 
+     * replicas are numbered consecutively after the unique jobs of the workload
+     */
+    std::string tag() const {
+        std::string number = std::to_string(this->index + this->replica * this->workload->num_jobs);
+        return this->workload->name.empty() ? number : this->workload->name + "_" + number;
+    }
+
+    std::string str() const {
+        return "job_" + this->tag();
+    }
+};
+
 /**
  * @brief Container to hold all job specific information
  * 
@@ -14,9 +54,9 @@
 struct JobSpecification {
 public:
     // identifier
-    std::string jobid;
+    JobID jobid;
     // Input files to process
-    std::vector<std::shared_ptr<wrench::DataFile>> infiles;
+    std::shared_ptr<const FileList> infiles;
     // Output file to write by the job
     std::shared_ptr<wrench::DataFile> outfile;
     // Desired destination of the output file to be written to
@@ -1,13 +1,29 @@
 #ifndef S_LRU_FILELIST_H
 #define S_LRU_FILELIST_H
 
+#include <list>
 #include <memory>
+#include <unordered_map>
 
 #include <wrench-dev.h>
 
 class LRU_FileList {
 
 public:
+    /**
+     * @brief Cumulative counters of the cache activity on the file collection
+     */
+    struct Counters {
+        /** @brief number of file accesses served from the collection **/
+        size_t hits = 0;
+        /** @brief number of file accesses, which had to be served elsewhere **/
+        size_t misses = 0;
+        /** @brief bytes of files added to the collection **/
+        double filled_bytes = 0.;
+        /** @brief bytes of files removed from the collection **/
+        double evicted_bytes = 0.;
+    };
+
     /**
      * @brief Touch a file to update its last access time
      * 
@@ -15,17 +31,17 @@ public:
      */
     void touchFile(wrench::DataFile  *file) {
         // If the file is new, then it's easy
-        if (this->indexed_files.find(file) == this->indexed_files.end()) {
-            this->indexed_files[file] = 0;
-            this->lru_list.insert(this->lru_list.begin(), file);
+        auto it = this->indexed_files.find(file);
+        if (it == this->indexed_files.end()) {
+            this->lru_list.push_front(file);
+            this->indexed_files[file] = this->lru_list.begin();
+            this->used_bytes += file->getSize();
+            this->counters.filled_bytes += file->getSize();
             return;
         }
 
-        // if the file is not new, then we need to do a bit of work
-        auto current_index = indexed_files[file];
-        this->lru_list.erase(this->lru_list.begin() + current_index);
-        this->indexed_files[file] = 0;
-        this->lru_list.insert(this->lru_list.begin(), file);
+        // if the file is not new, move its list node to the front, which keeps the stored iterator valid
+        this->lru_list.splice(this->lru_list.begin(), this->lru_list, it->second);
     }
 
     /**
@@ -38,9 +54,44 @@ public:
         auto file = this->lru_list.back();
         this->lru_list.pop_back();
         this->indexed_files.erase(file);
+        this->used_bytes -= file->getSize();
+        this->counters.evicted_bytes += file->getSize();
         return wrench::Simulation::getFileByID(file->getID());
     }
 
+    /**
+     * @brief Count an access to a file found in the collection
+     */
+    void recordHit() {
+        this->counters.hits++;
+    }
+
+    /**
+     * @brief Count an access to a file missing in the collection
+     */
+    void recordMiss() {
+        this->counters.misses++;
+    }
+
+    const Counters& getCounters() const {
+        return this->counters;
+    }
+
+    double getUsedBytes() const {
+        return this->used_bytes;
+    }
+
+    size_t getNumFiles() const {
+        return this->indexed_files.size();
+    }
+
+    /**
+     * @brief Files in the collection ordered by recency, front is most recently used
+     */
+    const std::list<wrench::DataFile *>& getFiles() const {
+        return this->lru_list;
+    }
+
     /**
      * @brief Checks whether a file is in the LRU list
      * @param file : a data file
@@ -52,10 +103,14 @@ public:
 
 
 private:
-    // File collection mapped to index
-    std::map<wrench::DataFile *, ssize_t> indexed_files;
+    // File collection mapped to its node in the LRU list
+    std::unordered_map<wrench::DataFile *, std::list<wrench::DataFile *>::iterator> indexed_files;
     // Ordered list of files in file collection -- front is most recently used.
-    std::vector<wrench::DataFile *> lru_list;
+    std::list<wrench::DataFile *> lru_list;
+    // Total size of the files in the collection
+    double used_bytes = 0.;
+    // Activity counters for monitoring
+    Counters counters;
 
 };
 
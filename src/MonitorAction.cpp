@@ -18,4 +18,7 @@ MonitorAction::MonitorAction(
     this->infile_transfer_time = DefaultValues::UndefinedDouble;
     // this->outfile_transfer_time = 0.;
     this->hitrate = DefaultValues::UndefinedDouble;
+    this->io_stall_time = DefaultValues::UndefinedDouble;
+    this->cached_data_size = DefaultValues::UndefinedDouble;
+    this->remote_data_size = DefaultValues::UndefinedDouble;
 }
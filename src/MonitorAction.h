@@ -5,6 +5,7 @@
 
 #include <wrench-dev.h>
 #include "util/DefaultValues.h"
+#include "ActivityAccounting.h"
 
 /**
  * @brief Extension of CustomAction to monitor job execution
@@ -34,6 +35,18 @@ public:
     double get_hitrate() {
         return hitrate;
     }
+    double get_io_stall_time() {
+        return io_stall_time;
+    }
+    double get_cached_data_size() {
+        return cached_data_size;
+    }
+    double get_remote_data_size() {
+        return remote_data_size;
+    }
+    ActivityCounters& get_activity_counters() {
+        return activity_counters;
+    }
 
     void set_infile_transfer_time(double value) {
         this->infile_transfer_time = value;
@@ -47,6 +60,15 @@ public:
     void set_hitrate(double value) {
         this->hitrate = value;
     }
+    void set_io_stall_time(double value) {
+        this->io_stall_time = value;
+    }
+    void set_cached_data_size(double value) {
+        this->cached_data_size = value;
+    }
+    void set_remote_data_size(double value) {
+        this->remote_data_size = value;
+    }
     
 protected:
     /** @brief Attribute monitoring accumulated transfer-time of input-files.
@@ -60,6 +82,15 @@ protected:
     /** @brief Attribute monitoring fraction of input-files read from cache.
      * This might be dependent on the cache definition. */
     double hitrate;
+    /** @brief Attribute monitoring the accumulated time the computation waited for input-data to be read.
+     * Transfer time not covered by this was overlapped with computation. */
+    double io_stall_time;
+    /** @brief Attribute monitoring the amount of input-data read from caches. */
+    double cached_data_size;
+    /** @brief Attribute monitoring the amount of input-data read from remote (GRID) storages. */
+    double remote_data_size;
+    /** @brief Attribute counting the simulation activities issued by the computation. */
+    ActivityCounters activity_counters;
 
 };
 
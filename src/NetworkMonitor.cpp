@@ -0,0 +1,156 @@
+
+
+#include "NetworkMonitor.h"
+#include "SimpleSimulator.h"
+
+#include <fstream>
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(network_monitor, "Log category for NetworkMonitor");
+
+
+/**
+ * @brief Utilization above which a link counts as saturated
+ */
+static const double saturation_threshold = 0.99;
+
+/**
+ * @brief Construct the network monitor
+ *
+ * @param link_names Names of the links to monitor
+ * @param hostname Host running the monitor
+ * @param interval Sampling interval in simulated seconds
+ *
+ * @throw std::invalid_argument
+ */
+NetworkMonitor::NetworkMonitor(
+        const std::vector<std::string>& link_names,
+        const std::string& hostname,
+        double interval) : wrench::ExecutionController(
+        hostname,
+        "network-monitor") {
+    if (interval <= 0.) {
+        throw std::invalid_argument("NetworkMonitor(): The sampling interval has to be positive!");
+    }
+    for (const auto& name : link_names) {
+        auto link = simgrid::s4u::Link::by_name(name);
+        if (!link) {
+            throw std::invalid_argument("NetworkMonitor(): Unknown link " + name + " on monitor host " + hostname);
+        }
+        this->links.push_back(link);
+    }
+    this->statistics.resize(this->links.size());
+    this->interval = interval;
+}
+
+/**
+ * @brief main method of the NetworkMonitor daemon
+ *
+ * @return 0 on completion
+ */
+int NetworkMonitor::main() {
+    WRENCH_INFO("Monitoring %lu links every %.2f s", this->links.size(), this->interval);
+    this->sample();
+    while (SimpleSimulator::active_execution_controllers > 0) {
+        wrench::Simulation::sleep(this->interval);
+        this->sample();
+    }
+    WRENCH_INFO("NetworkMonitor on host %s terminating after %lu samples", this->getHostname().c_str(), this->samples.size());
+    return 0;
+}
+
+/**
+ * @brief Take a sample of the current load of all monitored links
+ */
+void NetworkMonitor::sample() {
+    double now = wrench::Simulation::getCurrentSimulatedDate();
+    for (size_t i = 0; i < this->links.size(); i++) {
+        double load = this->links[i]->get_load();
+        this->samples.push_back({now, i, load});
+
+        double utilization = load / this->links[i]->get_bandwidth();
+        auto& stats = this->statistics[i];
+        if (utilization > stats.peak_utilization) {
+            stats.peak_utilization = utilization;
+            stats.peak_time = now;
+        }
+        stats.utilization_sum += utilization;
+        stats.num_samples++;
+        if (utilization >= saturation_threshold) {
+            stats.num_saturated++;
+        }
+    }
+}
+
+/**
+ * @brief Write the sampled link loads as CSV
+ *
+ * @param out Output stream
+ */
+void NetworkMonitor::writeTimeSeries(std::ostream& out) const {
+    for (const auto& s : this->samples) {
+        auto link = this->links[s.link];
+        out << std::to_string(s.time) << ", "
+            << link->get_name() << ", "
+            << std::to_string(s.load) << ", "
+            << s.load / link->get_bandwidth() << "\n";
+    }
+}
+
+/**
+ * @brief Write the utilization statistics of all monitored links as CSV
+ *
+ * @param out Output stream
+ */
+void NetworkMonitor::writeLinkSummary(std::ostream& out) const {
+    for (size_t i = 0; i < this->links.size(); i++) {
+        const auto& stats = this->statistics[i];
+        out << this->links[i]->get_name() << ", "
+            << std::to_string(this->links[i]->get_bandwidth()) << ", "
+            << (stats.num_samples > 0 ? stats.utilization_sum / stats.num_samples : 0.) << ", "
+            << stats.peak_utilization << ", "
+            << std::to_string(stats.peak_time) << ", "
+            << (stats.num_samples > 0 ? static_cast<double>(stats.num_saturated) / stats.num_samples : 0.) << "\n";
+    }
+}
+
+/**
+ * @brief Write the link load time series and the per-link utilization statistics
+ * of all network monitors as CSV files
+ *
+ * @param monitors Network monitors after the simulation
+ * @param timeseries_filename Path of the time series file
+ * @param summary_filename Path of the link statistics file, empty to skip it
+ *
+ * @throw std::runtime_error
+ */
+void NetworkMonitor::write(
+        const std::vector<std::shared_ptr<NetworkMonitor>>& monitors,
+        const std::string& timeseries_filename,
+        const std::string& summary_filename) {
+    std::ofstream timeseries(timeseries_filename, std::ios::out | std::ios::trunc);
+    if (!timeseries.is_open()) {
+        throw std::runtime_error("Couldn't open network monitor file " + timeseries_filename + " for dump!");
+    }
+    timeseries << "time, link.name, link.load, link.utilization\n";
+    for (const auto& monitor : monitors) {
+        monitor->writeTimeSeries(timeseries);
+    }
+    if (!timeseries.good()) {
+        throw std::runtime_error("Failed writing network monitor file " + timeseries_filename + "!");
+    }
+
+    if (summary_filename.empty()) {
+        return;
+    }
+    std::ofstream summary(summary_filename, std::ios::out | std::ios::trunc);
+    if (!summary.is_open()) {
+        throw std::runtime_error("Couldn't open network summary file " + summary_filename + " for dump!");
+    }
+    summary << "link.name, link.bandwidth, link.meanutilization, link.peakutilization, link.peaktime, link.saturatedfraction\n";
+    for (const auto& monitor : monitors) {
+        monitor->writeLinkSummary(summary);
+    }
+    if (!summary.good()) {
+        throw std::runtime_error("Failed writing network summary file " + summary_filename + "!");
+    }
+}
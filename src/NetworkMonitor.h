@@ -0,0 +1,61 @@
+
+
+#ifndef S_NETWORKMONITOR_H
+#define S_NETWORKMONITOR_H
+
+#include <wrench-dev.h>
+
+#include <ostream>
+
+/**
+ * @brief Actor running on a "networkmonitor" host, which periodically samples
+ * the load of network links in simulated time. It records the bandwidth utilization
+ * time series and the peak saturation of every monitored link.
+ * The monitor stops once all workload execution controllers have finished.
+ */
+class NetworkMonitor : public wrench::ExecutionController {
+public:
+    NetworkMonitor(
+        const std::vector<std::string>& link_names,
+        const std::string& hostname,
+        double interval
+    );
+
+    static void write(
+        const std::vector<std::shared_ptr<NetworkMonitor>>& monitors,
+        const std::string& timeseries_filename,
+        const std::string& summary_filename
+    );
+
+private:
+    int main() override;
+    void sample();
+    void writeTimeSeries(std::ostream& out) const;
+    void writeLinkSummary(std::ostream& out) const;
+
+    struct Sample {
+        double time;
+        size_t link;
+        double load;
+    };
+
+    /**
+     * @brief Utilization statistics of a link over all samples
+     */
+    struct LinkStatistics {
+        double peak_utilization = 0.;
+        double peak_time = 0.;
+        double utilization_sum = 0.;
+        size_t num_samples = 0;
+        size_t num_saturated = 0;
+    };
+
+    std::vector<simgrid::s4u::Link*> links;
+    std::vector<LinkStatistics> statistics;
+    std::vector<Sample> samples;
+
+    /** @brief sampling interval in simulated seconds **/
+    double interval;
+};
+
+#endif //S_NETWORKMONITOR_H
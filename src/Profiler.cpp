@@ -0,0 +1,142 @@
+
+
+#include "Profiler.h"
+#include "BenchmarkReport.h"
+
+#include <cstdio>
+#include <fstream>
+
+#include <unistd.h>
+
+
+/**
+ * @brief Start timing a scope
+ *
+ * @param profiler Profiler collecting the measurement, nullptr to disable the scope
+ * @param section Section the scope belongs to, e.g. 'main' or the name of an execution controller
+ * @param name Name of the scope within the section
+ */
+Profiler::Scope::Scope(std::shared_ptr<Profiler> profiler, const std::string& section, const std::string& name) : profiler(std::move(profiler)) {
+    if (this->profiler) {
+        this->section = section;
+        this->name = name;
+        this->start();
+    }
+}
+
+Profiler::Scope::~Scope() {
+    this->stop();
+}
+
+void Profiler::Scope::start() {
+    this->elapsed = 0.;
+    this->start_rss = getCurrentRSS();
+    this->start_time = Clock::now();
+    this->running = true;
+}
+
+/**
+ * @brief Stop the clock until the scope is resumed, e.g. while the simulation runs other actors
+ */
+void Profiler::Scope::pause() {
+    if (this->profiler && this->running) {
+        this->elapsed += std::chrono::duration<double>(Clock::now() - this->start_time).count();
+        this->running = false;
+    }
+}
+
+/**
+ * @brief Continue the clock of a paused scope
+ */
+void Profiler::Scope::resume() {
+    if (this->profiler && !this->running) {
+        this->start_time = Clock::now();
+        this->running = true;
+    }
+}
+
+/**
+ * @brief End the scope and add its measurement to the profiler. Subsequent calls do nothing.
+ */
+void Profiler::Scope::stop() {
+    if (!this->profiler) {
+        return;
+    }
+    this->pause();
+    this->profiler->add(this->section, this->name, this->elapsed, getCurrentRSS() - this->start_rss);
+    this->profiler.reset();
+}
+
+/**
+ * @brief End the scope and start the following one in the same section,
+ * to time consecutive phases of a function
+ *
+ * @param name Name of the following scope
+ */
+void Profiler::Scope::next(const std::string& name) {
+    if (!this->profiler) {
+        return;
+    }
+    auto profiler = this->profiler;
+    this->stop();
+    this->profiler = profiler;
+    this->name = name;
+    this->start();
+}
+
+/**
+ * @brief Add the measurement of a scope
+ *
+ * @param section Section of the scope
+ * @param name Name of the scope
+ * @param walltime Wall time in seconds
+ * @param rss_delta Growth of the resident memory in bytes
+ */
+void Profiler::add(const std::string& section, const std::string& name, double walltime, double rss_delta) {
+    auto key = std::make_pair(section, name);
+    auto it = this->entry_indices.find(key);
+    if (it == this->entry_indices.end()) {
+        it = this->entry_indices.emplace(key, this->entries.size()).first;
+        this->entries.push_back({section, name, 0, 0., 0.});
+    }
+    auto& entry = this->entries[it->second];
+    entry.calls++;
+    entry.walltime += walltime;
+    entry.rss_delta += rss_delta;
+}
+
+/**
+ * @brief Print a table of the number of calls, total and mean wall time and resident memory growth per scope
+ *
+ * @param os Stream to print into
+ */
+void Profiler::print(std::ostream& os) const {
+    char line[512];
+    std::snprintf(line, sizeof(line), "%-32s %-36s %10s %12s %12s %15s\n",
+                  "section", "scope", "calls", "total [s]", "mean [ms]", "RSS delta [MiB]");
+    os << "Profile of the simulator:\n" << line;
+    for (const auto& entry : this->entries) {
+        std::snprintf(line, sizeof(line), "%-32s %-36s %10zu %12.3f %12.3f %15.1f\n",
+                      entry.section.c_str(), entry.name.c_str(), entry.calls,
+                      entry.walltime, 1000. * entry.walltime / entry.calls, entry.rss_delta / (1024. * 1024.));
+        os << line;
+    }
+    os.flush();
+}
+
+/**
+ * @brief Current resident set size of the process,
+ * falls back to the peak resident set size where it is not available
+ *
+ * @return double, in bytes
+ */
+double Profiler::getCurrentRSS() {
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    long size = 0, resident = 0;
+    if (statm >> size >> resident) {
+        return static_cast<double>(resident) * sysconf(_SC_PAGESIZE);
+    }
+#endif
+    return BenchmarkReport::getPeakRSS();
+}
@@ -0,0 +1,84 @@
+
+
+#ifndef S_PROFILER_H
+#define S_PROFILER_H
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Lightweight profiler of the simulator's own wall time and resident memory,
+ * aggregated per named scope within a section (e.g. a startup phase, an execution controller or a computation).
+ *
+ * Calls into the simulation yield to all other actors, whose work would be attributed to the calling scope.
+ * Such calls are therefore excluded by pausing the scope around them.
+ */
+class Profiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Scoped timer adding its wall time and resident memory growth to the profiler when stopped or destroyed.
+     * Does nothing when constructed without profiler.
+     */
+    class Scope {
+    public:
+        Scope(std::shared_ptr<Profiler> profiler, const std::string& section, const std::string& name);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        void pause();
+        void resume();
+        void stop();
+        void next(const std::string& name);
+
+        /**
+         * @brief Run a call into the simulation, excluding its duration from the scope
+         *
+         * @param call Callable to run
+         */
+        template <class Call>
+        void excluding(Call&& call) {
+            this->pause();
+            call();
+            this->resume();
+        }
+
+    private:
+        void start();
+
+        std::shared_ptr<Profiler> profiler;
+        std::string section;
+        std::string name;
+        Clock::time_point start_time;
+        double elapsed = 0.;
+        double start_rss = 0.;
+        bool running = false;
+    };
+
+    void add(const std::string& section, const std::string& name, double walltime, double rss_delta);
+    void print(std::ostream& os) const;
+
+    static double getCurrentRSS();
+
+private:
+    struct Entry {
+        std::string section;
+        std::string name;
+        size_t calls;
+        double walltime;
+        double rss_delta;
+    };
+
+    std::vector<Entry> entries; // in order of first occurrence
+    std::map<std::pair<std::string, std::string>, size_t> entry_indices;
+};
+
+#endif //S_PROFILER_H
@@ -0,0 +1,174 @@
+
+
+#include "ResultWriter.h"
+#include "ArrowResultWriter.h"
+
+#include <charconv>
+#include <stdexcept>
+
+
+/**
+ * @brief Create the writer for the requested output format
+ *
+ * @param format Output format, one of 'csv', 'arrow' or 'parquet' as checked by the option validation
+ * @param filename Path of the output file
+ * @return std::shared_ptr<ResultWriter>
+ *
+ * @throw std::runtime_error
+ */
+std::shared_ptr<ResultWriter> ResultWriter::create(const std::string& format, const std::string& filename) {
+    if (format == "arrow" || format == "parquet") {
+#ifdef DCSIM_WITH_ARROW
+        return std::make_shared<ArrowResultWriter>(filename, format == "parquet");
+#else
+        throw std::runtime_error("Output format " + format + " requires building the simulator with Apache Arrow support!");
+#endif
+    }
+    return std::make_shared<CSVResultWriter>(filename);
+}
+
+/**
+ * @brief Open the output file, write the CSV header and start the background flushing thread
+ *
+ * @param filename Path of the output CSV file
+ * @param buffer_threshold Buffer size in bytes, above which the buffer is written out
+ *
+ * @throw std::runtime_error
+ */
+CSVResultWriter::CSVResultWriter(const std::string& filename, size_t buffer_threshold) : ResultWriter(filename) {
+    this->buffer_threshold = buffer_threshold;
+    this->file = std::fopen(filename.c_str(), "w");
+    if (!this->file) {
+        throw std::runtime_error("Couldn't open output-file " + filename + " for dump!");
+    }
+    this->buffer.reserve(buffer_threshold + 1024);
+    this->flush_buffer.reserve(buffer_threshold + 1024);
+
+    this->buffer += "job.tag, "; // << "job.ncpu" << ", " << "job.memory" << ", " << "job.disk" << ", ";
+    this->buffer += "machine.name, ";
+    this->buffer += "hitrate, ";
+    this->buffer += "job.submit, job.start, job.end, job.queuewait, job.computetime, job.iostalltime, job.overlap, ";
+    this->buffer += "infiles.transfertime, infiles.size, infiles.cachedsize, infiles.remotesize, outfiles.transfertime, outfiles.size\n";
+
+    this->flush_thread = std::thread(&CSVResultWriter::flushLoop, this);
+}
+
+CSVResultWriter::~CSVResultWriter() {
+    try {
+        this->close();
+    } catch (std::exception& e) {
+        std::fprintf(stderr, "Exception while closing output-file %s: %s\n", this->filename.c_str(), e.what());
+    }
+}
+
+/**
+ * @brief Append a job record as CSV line to the output
+ *
+ * @param record Information about the completed job
+ */
+void CSVResultWriter::write(const JobRecord& record) {
+    auto& b = this->buffer;
+    b += record.job_tag; b += ", ";
+    b += record.machine_name; b += ", ";
+    appendGeneral(record.hitrate); b += ", ";
+    appendFixed(record.submit_time); b += ", ";
+    appendFixed(record.start_time); b += ", ";
+    appendFixed(record.end_time); b += ", ";
+    appendFixed(record.queue_wait); b += ", ";
+    appendFixed(record.compute_time); b += ", ";
+    appendFixed(record.io_stall_time); b += ", ";
+    appendGeneral(record.overlap_fraction); b += ", ";
+    appendFixed(record.infile_transfer_time); b += ", ";
+    appendFixed(record.infile_size); b += ", ";
+    appendFixed(record.infile_cached_size); b += ", ";
+    appendFixed(record.infile_remote_size); b += ", ";
+    appendFixed(record.outfile_transfer_time); b += ", ";
+    appendFixed(record.outfile_size); b += '\n';
+
+    if (b.size() >= this->buffer_threshold) {
+        this->handOver();
+    }
+}
+
+/**
+ * @brief Write out all buffered records, stop the background thread and close the file
+ *
+ * @throw std::runtime_error
+ */
+void CSVResultWriter::close() {
+    if (!this->file) {
+        return;
+    }
+    if (!this->buffer.empty()) {
+        this->handOver();
+    }
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->closing = true;
+    }
+    this->condition.notify_all();
+    this->flush_thread.join();
+    bool failed = std::ferror(this->file);
+    failed |= (std::fclose(this->file) != 0);
+    this->file = nullptr;
+    if (failed) {
+        throw std::runtime_error("Failed writing output-file " + this->filename + "!");
+    }
+}
+
+/**
+ * @brief Append a number in fixed notation with 6 decimals (as std::to_string)
+ */
+void CSVResultWriter::appendFixed(double value) {
+    char chars[512];
+    auto result = std::to_chars(chars, chars + sizeof(chars), value, std::chars_format::fixed, 6);
+    if (result.ec == std::errc()) {
+        this->buffer.append(chars, result.ptr);
+    } else {
+        this->buffer += std::to_string(value);
+    }
+}
+
+/**
+ * @brief Append a number in general notation with 6 significant digits (as std::ostream)
+ */
+void CSVResultWriter::appendGeneral(double value) {
+    char chars[64];
+    auto result = std::to_chars(chars, chars + sizeof(chars), value, std::chars_format::general, 6);
+    this->buffer.append(chars, result.ptr);
+}
+
+/**
+ * @brief Hand the filled buffer over to the background thread.
+ * Waits in case the previous buffer has not been written out yet.
+ */
+void CSVResultWriter::handOver() {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->condition.wait(lock, [this]{ return !this->flush_pending; });
+    std::swap(this->buffer, this->flush_buffer);
+    this->flush_pending = true;
+    lock.unlock();
+    this->condition.notify_all();
+}
+
+/**
+ * @brief Main loop of the background thread writing out handed over buffers
+ */
+void CSVResultWriter::flushLoop() {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    while (true) {
+        this->condition.wait(lock, [this]{ return this->flush_pending || this->closing; });
+        if (this->flush_pending) {
+            // The producer does not touch the flush buffer while a flush is pending
+            lock.unlock();
+            std::fwrite(this->flush_buffer.data(), 1, this->flush_buffer.size(), this->file);
+            std::fflush(this->file);
+            lock.lock();
+            this->flush_buffer.clear();
+            this->flush_pending = false;
+            this->condition.notify_all();
+        } else if (this->closing) {
+            break;
+        }
+    }
+}
@@ -0,0 +1,97 @@
+
+
+#ifndef S_RESULTWRITER_H
+#define S_RESULTWRITER_H
+
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Information about a completed job, which is written to the simulation output
+ */
+struct JobRecord {
+    std::string job_tag;
+    std::string workload;
+    std::string machine_name;
+    double hitrate;
+    double submit_time;
+    double start_time;
+    double end_time;
+    /** @brief time from submission to the start of the first action **/
+    double queue_wait;
+    double compute_time;
+    /** @brief time the computation waited for input-data **/
+    double io_stall_time;
+    /** @brief fraction of the input-file transfer time overlapped with computation **/
+    double overlap_fraction;
+    double infile_transfer_time;
+    double infile_size;
+    double infile_cached_size;
+    double infile_remote_size;
+    double outfile_transfer_time;
+    double outfile_size;
+};
+
+/**
+ * @brief Process-wide writer of the job records into the simulation output
+ */
+class ResultWriter {
+public:
+    explicit ResultWriter(const std::string& filename) : filename(filename) {}
+    virtual ~ResultWriter() = default;
+
+    ResultWriter(const ResultWriter&) = delete;
+    ResultWriter& operator=(const ResultWriter&) = delete;
+
+    virtual void write(const JobRecord& record) = 0;
+    virtual void close() = 0;
+
+    const std::string& getFilename() const {
+        return this->filename;
+    }
+
+    static std::shared_ptr<ResultWriter> create(const std::string& format, const std::string& filename);
+
+protected:
+    std::string filename;
+};
+
+/**
+ * @brief Writer of the job records into the output CSV file.
+ * Records are formatted into an in-memory buffer, which is handed over
+ * to a background thread writing it out once it exceeds a size threshold,
+ * and when the writer is closed.
+ */
+class CSVResultWriter : public ResultWriter {
+public:
+    explicit CSVResultWriter(const std::string& filename, size_t buffer_threshold = 8*1024*1024);
+    ~CSVResultWriter() override;
+
+    void write(const JobRecord& record) override;
+    void close() override;
+
+private:
+    void appendFixed(double value);
+    void appendGeneral(double value);
+    void handOver();
+    void flushLoop();
+
+    FILE* file = nullptr;
+    size_t buffer_threshold;
+
+    /** @brief buffer records are currently formatted into **/
+    std::string buffer;
+    /** @brief buffer currently written out by the background thread **/
+    std::string flush_buffer;
+    bool flush_pending = false;
+    bool closing = false;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::thread flush_thread;
+};
+
+#endif //S_RESULTWRITER_H
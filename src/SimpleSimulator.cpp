@@ -11,15 +11,23 @@
 #include "SimpleSimulator.h"
 #include "WorkloadExecutionController.h"
 #include "JobSpecification.h"
+#include "WorkloadSnapshot.h"
+#include "CacheState.h"
+#include "ResultWriter.h"
+#include "SummaryResultWriter.h"
+#include "CacheMonitor.h"
+#include "NetworkMonitor.h"
+#include "BenchmarkReport.h"
+#include "DryRunEstimator.h"
 
 #include "util/Utils.h"
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <limits>
 
 #include <boost/program_options.hpp>
-#include <boost/regex.hpp>
-#include <boost/algorithm/string/replace.hpp>
 #include <boost/algorithm/string/case_conv.hpp>
 
 
@@ -37,12 +45,22 @@ const std::vector<std::string> workload_keys = {
         "workload_type", "submission_time"
     };
 std::map<std::shared_ptr<wrench::StorageService>, LRU_FileList> SimpleSimulator::global_file_map;
-std::mt19937 SimpleSimulator::gen(42);  // random number generator
-std::ofstream filedump; // output file stream to write monitoring dump to
+std::map<std::shared_ptr<wrench::StorageService>, std::unordered_set<wrench::DataFile*>> SimpleSimulator::origin_materialized_files;
+uint64_t SimpleSimulator::seed = 42;  // master seed of the random number generation
+std::shared_ptr<TraceRecorder> SimpleSimulator::trace_recorder = nullptr; // recorder of timeline events, only set when tracing
+std::shared_ptr<UtilizationMonitor> SimpleSimulator::utilization_monitor = nullptr; // accounting of worker usage, only set when monitoring
+std::shared_ptr<Profiler> SimpleSimulator::profiler = nullptr; // profiler of the simulator itself, only set when profiling
+std::shared_ptr<ActivityAccounting> SimpleSimulator::activity_accounting = nullptr; // simulation cost per job, only set when accounted
+std::shared_ptr<ConvergenceMonitor> SimpleSimulator::convergence_monitor = nullptr; // early termination of the simulation, only set when limited
+std::shared_ptr<StackDistanceAnalyzer> SimpleSimulator::stack_distance_analyzer = nullptr; // analysis of the cache accesses, only set when requested
+size_t SimpleSimulator::num_simulated_activities = 0; // counter of simulated activities to benchmark the simulator
+size_t SimpleSimulator::active_execution_controllers = 0; // monitors run while workload execution controllers are active
 bool SimpleSimulator::infile_caching_on = true; // flag to turn off/on the caching of job input-files
 bool SimpleSimulator::prefetching_on = true;   // flag to enable prefetching during streaming
 bool SimpleSimulator::shuffle_jobs = false;   // flag to enable job shuffling during submission
+bool SimpleSimulator::origin_storage = false;   // flag to let GRID storages hold all files implicitly without staging
 double SimpleSimulator::xrd_block_size = 1.*1000*1000*1000; // maximum size of the streamed file blocks in bytes for the XRootD-ish streaming
+double SimpleSimulator::storage_buffer_size = std::numeric_limits<double>::infinity(); // buffer size of the storage services in bytes
 // TODO: The initialized below is likely bogus (at compile time?)
 std::set<std::string> SimpleSimulator::cache_hosts;
 std::set<std::string> SimpleSimulator::storage_hosts;
@@ -96,6 +114,43 @@ void validate(boost::any& v, std::vector<std::string> const& values, cacheScope*
     }
 }
 
+/**
+ * @brief Simple Choices class for output format program option
+ * used as Custom Validator
+ */
+struct outputFormat {
+    outputFormat(std::string const& val): value(val) {}
+    std::string value;
+};
+/**
+ * @brief Operator<< for the outputFormat class
+ * 
+ * @param os 
+ * @param val 
+ * @return std::ostream& 
+ */
+std::ostream& operator<<(std::ostream &os, const outputFormat &val) {
+    os << val.value << " ";
+    return os; 
+}
+
+/**
+ * @brief Overload of boost::program_options validate method
+ * to check for custom validator classes
+ */
+void validate(boost::any& v, std::vector<std::string> const& values, outputFormat* /* target_type */, int) {
+    using namespace boost::program_options;
+
+    validators::check_first_occurrence(v);
+    std::string const& s = validators::get_single_string(values);
+
+    if (s == "csv" || s == "arrow" || s == "parquet") {
+        v = boost::any(outputFormat(s));
+    } else {
+        throw validation_error(validation_error::invalid_option_value);
+    }
+}
+
 /**
  * @brief Simple Choices class for workload type program option
  * used as Custom Validator: https://www.boost.org/doc/libs/1_48_0/doc/html/program_options/howto.html#id2445062
@@ -232,9 +287,12 @@ po::variables_map process_program_options(int argc, char** argv) {
 
     size_t duplications = 1;
 
+    unsigned long seed = 42;
+
     bool no_caching = false;
     bool prefetch_off = false;
     bool shuffle_jobs = false;
+    bool origin_storage = false;
 
     double xrd_block_size = 1000.*1000*1000;
     std::string storage_service_buffer_size = "1048576"; // 1MiB
@@ -262,13 +320,56 @@ po::variables_map process_program_options(int argc, char** argv) {
         ("workload-type", po::value<WorkloadTypeStruct>()->default_value(WorkloadTypeStruct("streaming")), "switch to define the type of the workload. Please choose from 'calculation', 'streaming', or 'copy'")
         ("submission-time", po::value<double>()->default_value(0.), "time to wait before submission of jobs")
 
+        ("save-workload", po::value<std::string>()->value_name("<snapshot file>"), "path of a binary snapshot file to store the generated workloads in")
+        ("load-workload", po::value<std::string>()->value_name("<snapshot file>"), "path of a binary snapshot file to load the workloads from instead of generating them. All workload options are ignored.")
+
+        ("save-cache-state", po::value<std::string>()->value_name("<state file>"), "path of a binary file to store the caches' contents and LRU order in at the end of the simulation")
+        ("load-cache-state", po::value<std::string>()->value_name("<state file>"), "path of a binary file to prepopulate the caches' contents and LRU order from at simulation start, in addition to the files staged according to the hitrate")
+
         ("duplications,d", po::value<size_t>()->default_value(duplications), "number of duplications of the workload to feed into the simulation")
 
+        ("seed", po::value<unsigned long>()->default_value(seed), "master seed of the random number generation")
+        ("sampling-threads", po::value<unsigned int>()->default_value(0), "number of threads used to sample the workloads' jobs (0: all hardware threads)")
+
         ("no-caching", po::bool_switch()->default_value(no_caching), "switch to turn on/off the caching of jobs' input-files")
         ("prefetch-off", po::bool_switch()->default_value(prefetch_off), "switch to turn on/off prefetching for streaming of input-files")
         ("shuffle-jobs", po::bool_switch()->default_value(shuffle_jobs), "switch to turn on/off shuffling jobs during submission")
-
-        ("output-file,o", po::value<std::string>()->value_name("<out file>")->required(), "path for the CSV file containing output information about the jobs in the simulation")
+        ("origin-storage", po::bool_switch()->default_value(origin_storage), "switch to let GRID storages act as origins holding all files implicitly, instead of staging every input-file onto them")
+
+        ("output-file,o", po::value<std::string>()->value_name("<out file>"), "path for the CSV file containing output information about the jobs in the simulation")
+        ("output-format", po::value<outputFormat>()->default_value(outputFormat("csv")), "Set the format of the output-file:\n csv: comma separated text\n arrow: Apache Arrow IPC stream\n parquet: Apache Parquet file\n (arrow and parquet require a build with Apache Arrow)")
+        ("summary", po::value<std::string>()->value_name("<summary file>"), "path for a JSON file containing statistics (count, mean, variance, quantiles) of the jobs' walltime, compute time, transfer time, hitrate and bytes read per workload and per host")
+        ("no-job-output", po::bool_switch()->default_value(false), "switch to disable the output of information about every job, only the summary is written")
+        ("trace-file", po::value<std::string>()->value_name("<trace file>"), "path for a Chrome trace JSON file (viewable in Perfetto) with the timeline of job submissions, executions, block reads and computations, cache evictions and output writes")
+        ("trace-buffer-size", po::value<size_t>()->default_value(1<<20), "maximal number of trace events kept in memory, only the most recent ones are written")
+        ("cache-monitor", po::value<std::string>()->value_name("<monitor file>"), "path for a CSV file containing a time series of the caches' occupancy, hits, misses, evicted and filled bytes")
+        ("cache-monitor-interval", po::value<double>()->default_value(60.), "interval in simulated seconds between two samples of the cache monitor")
+        ("bench-report", po::value<std::string>()->value_name("<report file>"), "path for a JSON file reporting the simulator's performance: wall time per phase, peak RSS, simulated activities and jobs per second")
+        ("activity-report", po::value<std::string>()->value_name("<report file>"), "path for a CSV file counting the simulated execs, reads, writes, file creations and deletions and storage messages per workload and workload type")
+        ("activity-jobs", po::value<std::string>()->value_name("<activity file>"), "path for a CSV file counting the simulated activities per job")
+        ("dry-run", po::bool_switch()->default_value(false), "only build the workloads and the platform, print an estimate of the simulation's size, wall time and peak memory as JSON and exit")
+        ("cost-model", po::value<std::string>()->value_name("<model file>"), "path for a JSON file with the calibrated coefficients of the cost model used by --dry-run")
+        ("profile", po::bool_switch()->default_value(false), "print the simulator's wall time and resident memory growth per startup phase, execution controller and computation step")
+        ("utilization-monitor", po::value<std::string>()->value_name("<monitor file>"), "path for a CSV file containing a time series of the average busy cores and used memory per worker host and site-wide")
+        ("utilization-summary", po::value<std::string>()->value_name("<summary file>"), "path for a CSV file containing the time-integrated core and memory utilization per worker host and site-wide")
+        ("utilization-interval", po::value<double>()->default_value(60.), "resolution in simulated seconds of the utilization time series")
+        ("network-monitor", po::value<std::string>()->value_name("<monitor file>"), "path for a CSV file containing a time series of the network links' load and utilization, sampled by the actors on hosts of type networkmonitor")
+        ("network-summary", po::value<std::string>()->value_name("<summary file>"), "path for a CSV file containing the mean and peak utilization of every monitored link")
+        ("network-monitor-interval", po::value<double>()->default_value(10.), "interval in simulated seconds between two samples of the network monitors")
+        ("monitored-links", po::value<std::vector<std::string>>()->multitoken()->default_value(std::vector<std::string>{}, ""), "List of names of the links to monitor (default: all links). A host property monitored_links (comma-separated) configures the links per network monitor host.")
+
+        ("max-sim-time", po::value<double>()->value_name("<seconds>"), "simulated time after which the simulation is stopped, only completed jobs are written out")
+        ("max-completed-jobs", po::value<size_t>()->value_name("<jobs>"), "number of completed jobs after which the simulation is stopped")
+        ("steady-state", po::bool_switch()->default_value(false), "switch to stop the simulation once the job throughput and byte hitrate are stable over consecutive windows")
+        ("steady-state-window", po::value<double>()->default_value(600.), "duration in simulated seconds of the windows the steady state is detected on")
+        ("steady-state-windows", po::value<size_t>()->default_value(5), "number of consecutive windows, which have to be stable")
+        ("steady-state-tolerance", po::value<double>()->default_value(0.05), "maximal spread of the windows' job throughput and byte hitrate relative to their mean")
+        ("warmup", po::value<double>()->default_value(0.), "simulated time at the start, whose completed jobs are excluded from the steady-state detection and the summary")
+        ("steady-state-report", po::value<std::string>()->value_name("<report file>"), "path for a CSV file containing the job throughput and byte hitrate per window after the warm-up")
+
+        ("hit-ratio-curve", po::value<std::string>()->value_name("<curve file>"), "path for a CSV file containing the LRU hitrate and byte hitrate over all cache capacities per cache scope, obtained from the stack distances of the input-file accesses")
+        ("hrc-sampling-rate", po::value<double>()->default_value(1.), "fraction of the files sampled by the stack-distance analysis (1: exact analysis of all files)")
+        ("hrc-points", po::value<size_t>()->default_value(100), "number of equidistant cache capacities the hit-ratio curve is written at")
 
         ("xrd-blocksize,x", po::value<double>()->default_value(xrd_block_size), "size of the blocks XRootD uses for data streaming")
         ("storage-buffer-size,b", po::value<StorageServiceBufferValue>()->default_value(StorageServiceBufferValue(storage_service_buffer_size)), "buffer size used by the storage services when communicating data")
@@ -289,6 +390,13 @@ po::variables_map process_program_options(int argc, char** argv) {
 
     try {
         po::notify(vm);
+        if (vm["no-job-output"].as<bool>()) {
+            if (!vm.count("summary")) {
+                throw std::invalid_argument("the option '--no-job-output' requires '--summary'");
+            }
+        } else if (!vm.count("output-file") && !vm["dry-run"].as<bool>()) {
+            throw std::invalid_argument("the option '--output-file' is required but missing");
+        }
     } catch (std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl << std::endl;
         std::cerr << desc << std::endl;
@@ -303,36 +411,32 @@ po::variables_map process_program_options(int argc, char** argv) {
 
 
 /**
- * @brief Method to duplicate the jobs of a workload
+ * @brief Method to duplicate the jobs of a workload.
+ * Replicas share the immutable input-file list of the original job,
+ * only a new output file is created for each of them.
  * 
  * @param workload Workload containing jobs to duplicate
  * @param duplications Number of duplications each job is duplicated
- * @return std::map<std::string, JobSpecification> 
+ * @return std::vector<JobSpecification> 
  */
-std::map<std::string, JobSpecification> duplicateJobs(std::map<std::string, JobSpecification>& workload, size_t duplications, std::set<std::shared_ptr<wrench::StorageService>> grid_storage_services) {
+std::vector<JobSpecification> duplicateJobs(std::vector<JobSpecification>& workload, size_t duplications, std::set<std::shared_ptr<wrench::StorageService>> grid_storage_services) {
     size_t num_jobs = workload.size();
-    std::map<std::string, JobSpecification> dupl_workload;
+    std::vector<JobSpecification> dupl_workload;
+    dupl_workload.reserve(num_jobs * duplications);
     std::cerr << "\tDuplicating workload " << &workload << " with " << std::to_string(num_jobs) << " jobs ";
     for (auto & job_spec: workload) {
-        boost::smatch job_index_matches;
-        boost::regex job_index_expression{"\\d+"};
-        boost::regex_search(job_spec.first, job_index_matches,  job_index_expression);
         for (size_t d=0; d < duplications; d++) {
-            size_t dup_index;
-            std::stringstream job_index_sstream(job_index_matches[job_index_matches.size()-1]);
-            job_index_sstream >> dup_index;
-            dup_index += num_jobs * d;
-            std::string dupl_job_id = boost::replace_last_copy(job_spec.first, job_index_matches[job_index_matches.size()-1], std::to_string(dup_index));
-            JobSpecification dupl_job_specs = job_spec.second;
+            JobSpecification dupl_job_specs = job_spec;
+            dupl_job_specs.jobid.replica = job_spec.jobid.replica + d;
             if (d > 0) {
-                dupl_job_specs.outfile = wrench::Simulation::addFile(boost::replace_last_copy(dupl_job_specs.outfile->getID(), job_index_matches[job_index_matches.size()-1], std::to_string(dup_index)), dupl_job_specs.outfile->getSize());
+                dupl_job_specs.outfile = wrench::Simulation::addFile("outfile_" + dupl_job_specs.jobid.tag(), dupl_job_specs.outfile->getSize());
                 // TODO: Think of a better way to copy the outfile destination
                 for (auto ss : grid_storage_services) {
                     dupl_job_specs.outfile_destination = wrench::FileLocation::LOCATION(ss, dupl_job_specs.outfile);
                     break;
                 }
             }
-            dupl_workload.insert(std::make_pair(dupl_job_id, dupl_job_specs));
+            dupl_workload.push_back(std::move(dupl_job_specs));
         }
     }
     std::cerr << "-> New workload has " << dupl_workload.size() << " jobs\n";
@@ -340,6 +444,22 @@ std::map<std::string, JobSpecification> duplicateJobs(std::map<std::string, JobS
 }
 
 
+/**
+ * @brief Named random stream of a subsystem derived from the master seed.
+ * Every subsystem and entity (e.g. workload or job) draws from its own stream, so a different
+ * number of draws in one of them, e.g. due to another parameter value, leaves the random values
+ * of all others unchanged (common random numbers across the points of a scan).
+ *
+ * @param subsystem Name of the subsystem drawing the random numbers
+ * @param entity Name of the entity the numbers are drawn for within the subsystem
+ * @param index Index of the stream within the entity
+ * @return Philox4x32
+ */
+Philox4x32 SimpleSimulator::randomStream(const std::string& subsystem, const std::string& entity, uint64_t index) {
+    return Philox4x32(mix64(SimpleSimulator::seed ^ mix64(fnv1a_64(entity, fnv1a_64(subsystem + "/")))), index);
+}
+
+
 /**
  * @brief Identify demanded services on hosts to run based on configured "type" property tag
  * 
@@ -429,8 +549,16 @@ void SimpleSimulator::fillHostsInSiblingZonesMap(bool include_subzones = false)
 }
 
 
+#ifndef DCSIM_NO_MAIN
 int main(int argc, char **argv) {
 
+    // Timing of the simulator's phases
+    BenchmarkReport bench;
+    bench.startPhase("initialization");
+    // Finer grained profiling of the phases, only kept with --profile
+    auto profiler = std::make_shared<Profiler>();
+    Profiler::Scope phase(profiler, "main", "option parsing");
+
     // instantiate a simulation
     auto simulation = wrench::Simulation::createSimulation();
 
@@ -439,12 +567,18 @@ int main(int argc, char **argv) {
 
     /* Parsing of the command-line arguments for this WRENCH simulation */
     auto vm = process_program_options(argc, argv);
+    if (vm["profile"].as<bool>()) {
+        SimpleSimulator::profiler = profiler;
+    }
 
     // The first argument is the platform description file, written in XML following the SimGrid-defined DTD
     std::string platform_file = vm["platform"].as<std::string>();
 
     // output-file name containing simulation information
-    std::string filename = vm["output-file"].as<std::string>();
+    bool job_output = !vm["no-job-output"].as<bool>() && vm.count("output-file");
+    std::string filename = job_output ? vm["output-file"].as<std::string>() : "";
+    std::string output_format = vm["output-format"].as<outputFormat>().value;
+    std::string summary_filename = vm.count("summary") ? vm["summary"].as<std::string>() : "";
 
     size_t num_jobs = vm["njobs"].as<size_t>();
     size_t infiles_per_job = vm["ninfiles"].as<size_t>();
@@ -464,6 +598,12 @@ int main(int argc, char **argv) {
     double submission_arrival_time = vm["submission-time"].as<double>();
 
     size_t duplications = vm["duplications"].as<size_t>();
+
+    // Seed the random number generation
+    unsigned long seed = vm["seed"].as<unsigned long>();
+    SimpleSimulator::seed = seed;
+    Workload::sampling_threads = vm["sampling-threads"].as<unsigned int>();
+
     std::vector<std::string> workload_configurations = vm["workload-configurations"].as<std::vector<std::string>>();
 
     // Flags to turn on/off the caching of jobs' input-files
@@ -477,11 +617,61 @@ int main(int argc, char **argv) {
     std::cerr << "Job shuffling on?: " << vm["shuffle-jobs"].as<bool>() << std::endl;
     SimpleSimulator::shuffle_jobs = vm["shuffle-jobs"].as<bool>();
 
+    // Flag to turn on GRID storages as origins of all files
+    std::cerr << "Origin storage on?: " << vm["origin-storage"].as<bool>() << std::endl;
+    SimpleSimulator::origin_storage = vm["origin-storage"].as<bool>();
+
     // Set XRootD block size
     SimpleSimulator::xrd_block_size = vm["xrd-blocksize"].as<double>();
 
+    // Opt-in recording of timeline events
+    if (vm.count("trace-file")) {
+        SimpleSimulator::trace_recorder = std::make_shared<TraceRecorder>(vm["trace-file"].as<std::string>(), vm["trace-buffer-size"].as<size_t>());
+    }
+
     // Set StorageService buffer size/type
     std::string buffer_size = vm["storage-buffer-size"].as<StorageServiceBufferValue>().get();
+    if (vm["storage-buffer-size"].as<StorageServiceBufferValue>().getType() == StorageServiceBufferType::Infinity) {
+        SimpleSimulator::storage_buffer_size = std::numeric_limits<double>::infinity();
+    } else {
+        SimpleSimulator::storage_buffer_size = std::stod(buffer_size);
+    }
+
+    // Optional accounting of the simulation activities issued per job
+    if (vm.count("activity-report") || vm.count("activity-jobs")) {
+        SimpleSimulator::activity_accounting = std::make_shared<ActivityAccounting>(
+            SimpleSimulator::xrd_block_size, buffer_size,
+            vm.count("activity-jobs") ? vm["activity-jobs"].as<std::string>() : ""
+        );
+    }
+
+    // Optional early termination of the simulation
+    if (vm.count("max-sim-time") || vm.count("max-completed-jobs") || vm["steady-state"].as<bool>() || vm.count("steady-state-report")) {
+        try {
+            SimpleSimulator::convergence_monitor = std::make_shared<ConvergenceMonitor>(
+                vm["warmup"].as<double>(),
+                vm["steady-state-window"].as<double>(),
+                vm["steady-state-windows"].as<size_t>(),
+                vm["steady-state-tolerance"].as<double>(),
+                vm["steady-state"].as<bool>(),
+                vm.count("max-sim-time") ? vm["max-sim-time"].as<double>() : std::numeric_limits<double>::infinity(),
+                vm.count("max-completed-jobs") ? vm["max-completed-jobs"].as<size_t>() : 0
+            );
+        } catch (std::invalid_argument &e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Optional stack-distance analysis of the cache accesses
+    if (vm.count("hit-ratio-curve")) {
+        try {
+            SimpleSimulator::stack_distance_analyzer = std::make_shared<StackDistanceAnalyzer>(vm["hrc-sampling-rate"].as<double>(), vm["hrc-points"].as<size_t>());
+        } catch (std::invalid_argument &e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
 
     // Choice of cache locality scope
     std::string scope_caches = vm["cache-scope"].as<cacheScope>().value;
@@ -496,11 +686,18 @@ int main(int argc, char **argv) {
 
 
     /* Create a workload */
+    bench.startPhase("workload");
+    phase.next("workload sampling");
     std::cerr << "Constructing workload specification..." << std::endl;
 
     std::vector<Workload> workload_specs = {};
 
-    if(workload_configurations.size() == 0){
+    if (vm.count("load-workload")) {
+        std::string snapshot_path = vm["load-workload"].as<std::string>();
+        std::cerr << "Loading workloads from snapshot " << snapshot_path << "..." << std::endl;
+        workload_specs = WorkloadSnapshot::load(snapshot_path);
+    }
+    else if(workload_configurations.size() == 0){
         std::cerr << "Trying to create a single workload from CLI parameters, consider using a workload config instead..." << std::endl;
         workload_specs.push_back(
             Workload(
@@ -512,7 +709,7 @@ int main(int argc, char **argv) {
                 average_outfile_size, sigma_outfile_size,
                 vm["workload-type"].as<WorkloadTypeStruct>().get(), "",
                 submission_arrival_time,
-                SimpleSimulator::gen
+                seed
             )
         );
 
@@ -548,7 +745,7 @@ int main(int argc, char **argv) {
                         wf.value()["infilesize"], wf.value()["outfilesize"],
                         get_workload_type(workload_type_lower), wf.key(),
                         wf.value()["submission_time"],
-                        SimpleSimulator::gen
+                        seed
                     )
                 );
                 std::cerr << "\tThe workload " << std::string(wf.key()) << " has " << wf.value()["num_jobs"] << " unique jobs" << std::endl;
@@ -557,15 +754,25 @@ int main(int argc, char **argv) {
     }
     std::cerr << "Created " << workload_specs.size() << " unique workloads!" << "\n";
 
+    if (vm.count("save-workload")) {
+        std::string snapshot_path = vm["save-workload"].as<std::string>();
+        std::cerr << "Saving workloads to snapshot " << snapshot_path << "..." << std::endl;
+        WorkloadSnapshot::save(workload_specs, snapshot_path);
+    }
+
     /* Read and parse the platform description file to instantiate a simulation platform */
+    bench.startPhase("platform");
     std::cerr << "Instantiating SimGrid platform..." << std::endl;
+    phase.next("platform instantiation");
     simulation->instantiatePlatform(platform_file);
 
 
     /* Identify demanded and create storage and compute services and add them to the simulation */
+    phase.next("host typing");
     SimpleSimulator::identifyHostTypes(simulation);
 
     // Fill reachable caches map
+    phase.next("zone mapping");
     if (rec_netzone_caches) {
         SimpleSimulator::fillHostsInSiblingZonesMap();
     } else {
@@ -576,7 +783,31 @@ int main(int argc, char **argv) {
         }
     }
 
+    /* Only estimate the cost of the simulation without running it */
+    if (vm["dry-run"].as<bool>()) {
+        try {
+            auto cost_model = vm.count("cost-model") ? DryRunEstimator::CostModel::load(vm["cost-model"].as<std::string>()) : DryRunEstimator::CostModel();
+            auto estimate = DryRunEstimator::estimate(
+                workload_specs, duplications,
+                SimpleSimulator::storage_hosts.size(), SimpleSimulator::cache_hosts.size(),
+                hitrate, SimpleSimulator::origin_storage,
+                SimpleSimulator::xrd_block_size, SimpleSimulator::storage_buffer_size,
+                cost_model
+            );
+            std::cerr << "Dry run: " << estimate.jobs << " jobs with " << estimate.files << " files and " << estimate.blocks << " blocks, "
+                      << estimate.activities << " activities and " << estimate.messages << " messages, "
+                      << "predicted wall time " << estimate.walltime << " s and peak memory " << estimate.peak_memory / 1.e9 << " GB" << std::endl;
+            nlohmann::json report = {{"estimate", estimate.toJSON()}, {"cost_model", cost_model.toJSON()}};
+            std::cout << report.dump(4) << std::endl;
+        } catch (std::exception &e) {
+            std::cerr << "Exception: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
     // Create a list of cache storage services
+    phase.next("service creation");
     std::set<std::shared_ptr<wrench::StorageService>> cache_storage_services;
     for (auto host: SimpleSimulator::cache_hosts) {
         //TODO: Support more than one type of cache mounted differently?
@@ -660,6 +891,22 @@ int main(int argc, char **argv) {
     }
 
 
+    /* Initialize output-dump file */
+    std::shared_ptr<ResultWriter> result_writer;
+    try {
+        if (job_output) {
+            result_writer = ResultWriter::create(output_format, filename);
+            std::cerr << "Opened " << output_format << " output dump in file " << filename << std::endl;
+        }
+        if (!summary_filename.empty()) {
+            result_writer = std::make_shared<SummaryResultWriter>(summary_filename, result_writer, vm["warmup"].as<double>());
+            std::cerr << "Job statistics will be summarized in file " << summary_filename << std::endl;
+        }
+    } catch (std::runtime_error &e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 0;
+    }
+
     /* Instantiate Execution Controllers */
     std::set<std::shared_ptr<WorkloadExecutionController>> workload_execution_controllers;
     //TODO: Think of a way to support more than one execution controller host
@@ -676,9 +923,9 @@ int main(int argc, char **argv) {
                     grid_storage_services,
                     cache_storage_services,
                     host,
-                    filename,
+                    result_writer,
                     SimpleSimulator::shuffle_jobs,
-                    SimpleSimulator::gen
+                    SimpleSimulator::randomStream("job-shuffle", workload_spec.job_batch.empty() ? "" : workload_spec.job_batch.front().jobid.workload->name)
                 )
             );
             std::cerr << "\tCreated execution controller " << wms->getName() << " executing workload " << &workload_spec << " with " << workload_spec.job_batch.size() << " jobs to simulate\n";
@@ -687,25 +934,87 @@ int main(int argc, char **argv) {
         std::cerr << "Total number of execution controllers: " << workload_execution_controllers.size() << "\n";
     }
 
+    /* Instantiate monitors */
+    if (vm.count("utilization-monitor")) {
+        SimpleSimulator::utilization_monitor = std::make_shared<UtilizationMonitor>(SimpleSimulator::worker_hosts, vm["utilization-interval"].as<double>());
+    }
+    std::shared_ptr<CacheMonitor> cache_monitor;
+    if (vm.count("cache-monitor")) {
+        cache_monitor = simulation->add(
+            new CacheMonitor(
+                cache_storage_services,
+                *SimpleSimulator::executors.begin(),
+                vm["cache-monitor-interval"].as<double>(),
+                vm["cache-monitor"].as<std::string>()
+            )
+        );
+        std::cerr << "Created cache monitor sampling every " << vm["cache-monitor-interval"].as<double>() << " s" << std::endl;
+    }
+    std::vector<std::shared_ptr<NetworkMonitor>> network_monitors;
+    if (vm.count("network-monitor")) {
+        if (SimpleSimulator::network_monitors.empty()) {
+            throw std::runtime_error("Network monitoring requires at least one host of type networkmonitor in the platform!");
+        }
+        // Links to monitor when not configured per host: the given list or all links,
+        // distributed over the monitor hosts without configuration
+        std::vector<std::string> link_names = vm["monitored-links"].as<std::vector<std::string>>();
+        if (link_names.empty()) {
+            for (auto link: simgrid::s4u::Engine::get_instance()->get_all_links()) {
+                link_names.push_back(link->get_name());
+            }
+        }
+        std::vector<std::string> unconfigured_monitors;
+        std::map<std::string, std::vector<std::string>> links_per_monitor;
+        for (const auto& host: SimpleSimulator::network_monitors) {
+            const char* host_links = simgrid::s4u::Host::by_name(host)->get_property("monitored_links");
+            if (host_links) {
+                std::stringstream links_stream(host_links);
+                std::string link_name;
+                while (std::getline(links_stream, link_name, ',')) {
+                    if (!link_name.empty()) links_per_monitor[host].push_back(link_name);
+                }
+            } else {
+                unconfigured_monitors.push_back(host);
+                links_per_monitor[host];
+            }
+        }
+        for (size_t l = 0; !unconfigured_monitors.empty() && l < link_names.size(); l++) {
+            links_per_monitor[unconfigured_monitors[l % unconfigured_monitors.size()]].push_back(link_names[l]);
+        }
+        for (const auto& [host, links]: links_per_monitor) {
+            network_monitors.push_back(simulation->add(new NetworkMonitor(links, host, vm["network-monitor-interval"].as<double>())));
+            std::cerr << "Created network monitor on host " << host << " sampling " << links.size() << " links" << std::endl;
+        }
+    }
+
     /* Instantiate inputfiles and set outfile destinations*/
+    bench.startPhase("staging");
+    phase.next("file staging");
     std::cerr << "Creating and staging input files plus set destination of output files..." << std::endl;
     for (auto wms: workload_execution_controllers) {
         try {
             for (auto &job_spec: wms->get_workload_spec()) {
-                std::shuffle(job_spec.second.infiles.begin(), job_spec.second.infiles.end(), SimpleSimulator::gen); // Shuffle the input files
+                // Shuffle the input files, before they are frozen and shared with replicas
+                auto infiles = std::make_shared<FileList>(*job_spec.infiles);
+                auto infile_shuffle = SimpleSimulator::randomStream("infile-shuffle", job_spec.jobid.workload->name, job_spec.jobid.index);
+                std::shuffle(infiles->begin(), infiles->end(), infile_shuffle);
+                job_spec.infiles = infiles;
                 // Compute the job's incremental inputfiles size
                 double incr_inputfile_size = 0.;
-                for (auto const &f : job_spec.second.infiles) {
+                for (auto const &f : *job_spec.infiles) {
                     incr_inputfile_size += f->getSize();
                 }
                 double cached_files_size = 0.;
-                for (auto const &f : job_spec.second.infiles) {
-                    // Distribute the inputfiles on all GRID storages
+                for (auto const &f : *job_spec.infiles) {
+                    // Distribute the inputfiles on all GRID storages, 
+                    // unless they act as origins providing files on first access
                     //TODO: Think of a more realistic distribution pattern and avoid duplications
-                    for (auto storage_service: grid_storage_services) {
-                        // simulation->stageFile(f, storage_service);
-                        simulation->stageFile(wrench::FileLocation::LOCATION(storage_service, f));
-                        SimpleSimulator::global_file_map[storage_service].touchFile(f.get());
+                    if (!SimpleSimulator::origin_storage) {
+                        for (auto storage_service: grid_storage_services) {
+                            // simulation->stageFile(f, storage_service);
+                            simulation->stageFile(wrench::FileLocation::LOCATION(storage_service, f));
+                            SimpleSimulator::global_file_map[storage_service].touchFile(f.get());
+                        }
                     }
                     // Distribute the infiles on all caches until desired hitrate is reached
                     //TODO: Rework the initialization of input files on caches
@@ -725,7 +1034,7 @@ int main(int argc, char **argv) {
                 // Set outfile destinations
                 // TODO: Think of a way to identify a specific (GRID) storage
                 for (auto storage_service: grid_storage_services) {
-                    job_spec.second.outfile_destination = wrench::FileLocation::LOCATION(storage_service, job_spec.second.outfile);
+                    job_spec.outfile_destination = wrench::FileLocation::LOCATION(storage_service, job_spec.outfile);
                     break;
                 }
             }
@@ -735,41 +1044,105 @@ int main(int argc, char **argv) {
         }
     }
 
+    if (vm.count("load-cache-state")) {
+        try {
+            CacheState::load(vm["load-cache-state"].as<std::string>(), cache_storage_services, simulation);
+        } catch (std::runtime_error &e) {
+            std::cerr << "Exception: " << e.what() << std::endl;
+            return 0;
+        }
+    }
+
+    bench.startPhase("duplication");
+    phase.next("duplication");
     std::cerr << "Duplicating workloads ... " << "\n";
     size_t num_total_jobs = 0;
     for (auto wms: workload_execution_controllers) {
         /* Duplicate the workload */
         auto new_workload_spec = duplicateJobs(wms->get_workload_spec(), duplications, grid_storage_services);
-        wms->set_workload_spec(new_workload_spec);
         num_total_jobs += new_workload_spec.size();
+        wms->set_workload_spec(std::move(new_workload_spec));
     }
     std::cerr << "The simulation now has " << std::to_string(num_total_jobs) << " jobs in total " << std::endl;
 
 
     /* Launch the simulation */
     try {
-        /* initialize output-dump file */
-        filedump.open(filename, ios::out | ios::trunc);
-        if (filedump.is_open()) {
-            filedump << "job.tag" << ", "; // << "job.ncpu" << ", " << "job.memory" << ", " << "job.disk" << ", ";
-            filedump << "machine.name" << ", ";
-            filedump << "hitrate" << ", ";
-            filedump << "job.start" << ", " << "job.end" << ", " << "job.computetime" << ", ";
-            filedump << "infiles.transfertime" << ", " << "infiles.size" << ", " << "outfiles.transfertime" << ", " << "outfiles.size" << "\n";
-            filedump.close();
-            std::cerr << "Wrote header of the output dump into file " << filename << std::endl;
-        }
-        else {
-            throw std::runtime_error("Couldn't open output-file " + filename + " for dump!");
-        }
         std::cerr << "Launching the Simulation..." << std::endl;
+        bench.startPhase("simulation");
+        phase.next("launch");
         simulation->launch();
+        bench.startPhase("output");
+        phase.next("output");
+        /* Write out all buffered job information */
+        result_writer->close();
+        if (cache_monitor) {
+            cache_monitor->write();
+        }
+        if (SimpleSimulator::utilization_monitor) {
+            SimpleSimulator::utilization_monitor->write(
+                vm["utilization-monitor"].as<std::string>(),
+                vm.count("utilization-summary") ? vm["utilization-summary"].as<std::string>() : ""
+            );
+        }
+        if (!network_monitors.empty()) {
+            NetworkMonitor::write(
+                network_monitors,
+                vm["network-monitor"].as<std::string>(),
+                vm.count("network-summary") ? vm["network-summary"].as<std::string>() : ""
+            );
+        }
+        if (vm.count("save-cache-state")) {
+            CacheState::save(cache_storage_services, vm["save-cache-state"].as<std::string>());
+        }
+        if (SimpleSimulator::convergence_monitor) {
+            SimpleSimulator::convergence_monitor->print(std::cerr);
+            if (vm.count("steady-state-report")) {
+                SimpleSimulator::convergence_monitor->write(vm["steady-state-report"].as<std::string>());
+            }
+        }
+        if (SimpleSimulator::stack_distance_analyzer) {
+            SimpleSimulator::stack_distance_analyzer->print(std::cerr);
+            SimpleSimulator::stack_distance_analyzer->write(vm["hit-ratio-curve"].as<std::string>());
+        }
+        if (SimpleSimulator::activity_accounting) {
+            SimpleSimulator::activity_accounting->print(std::cerr);
+            if (vm.count("activity-report")) {
+                SimpleSimulator::activity_accounting->write(vm["activity-report"].as<std::string>());
+            }
+        }
+        if (SimpleSimulator::trace_recorder) {
+            SimpleSimulator::trace_recorder->write();
+            std::cerr << "Wrote timeline trace into file " << SimpleSimulator::trace_recorder->getFilename() << std::endl;
+        }
     } catch (std::runtime_error &e) {
         std::cerr << "Exception: " << e.what() << std::endl;
         return 0;
     }
     std::cerr << "Simulation done! " << wrench::Simulation::getCurrentSimulatedDate() << std::endl;
 
+    phase.stop();
+    if (SimpleSimulator::profiler) {
+        SimpleSimulator::profiler->print(std::cerr);
+    }
+
+    if (vm.count("bench-report")) {
+        bench.endPhase();
+        double simulation_walltime = bench.getPhaseDuration("simulation");
+        bench.set("jobs", num_total_jobs);
+        bench.set("activities", SimpleSimulator::num_simulated_activities);
+        bench.set("simulated_time", wrench::Simulation::getCurrentSimulatedDate());
+        if (simulation_walltime > 0.) {
+            bench.set("jobs_per_second", num_total_jobs / simulation_walltime);
+            bench.set("activities_per_second", SimpleSimulator::num_simulated_activities / simulation_walltime);
+        }
+        try {
+            bench.write(vm["bench-report"].as<std::string>());
+        } catch (std::runtime_error &e) {
+            std::cerr << "Exception: " << e.what() << std::endl;
+        }
+    }
+
     // Check routes from workers to remote storages
 #if 0
     for (auto worker_host_name: SimpleSimulator::worker_hosts) {
@@ -790,3 +1163,4 @@ int main(int argc, char **argv) {
 
     return 0;
 }
+#endif //DCSIM_NO_MAIN
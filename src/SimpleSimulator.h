@@ -3,8 +3,17 @@
 #ifndef S_SIMPLESIMULATOR_H
 #define S_SIMPLESIMULATOR_H
 
+#include <unordered_set>
+
 #include "LRU_FileList.h"
 #include "Workload.h"
+#include "TraceRecorder.h"
+#include "UtilizationMonitor.h"
+#include "Profiler.h"
+#include "ActivityAccounting.h"
+#include "ConvergenceMonitor.h"
+#include "StackDistanceAnalyzer.h"
+#include "util/Philox.h"
 
 class SimpleSimulator {
 
@@ -28,9 +37,21 @@ public:
     static bool infile_caching_on;
     static bool prefetching_on;
     static bool shuffle_jobs;
+    static bool origin_storage;
     static std::map<std::shared_ptr<wrench::StorageService>, LRU_FileList> global_file_map;
+    static std::map<std::shared_ptr<wrench::StorageService>, std::unordered_set<wrench::DataFile*>> origin_materialized_files; // files already created on origin storages
     static double xrd_block_size;
-    static std::mt19937 gen;
+    static double storage_buffer_size; // buffer size of the storage services in bytes, infinity for full buffering
+    static uint64_t seed; // master seed all random streams are derived from
+    static Philox4x32 randomStream(const std::string& subsystem, const std::string& entity, uint64_t index = 0);
+    static std::shared_ptr<TraceRecorder> trace_recorder; // timeline event recorder, nullptr when tracing is off
+    static std::shared_ptr<UtilizationMonitor> utilization_monitor; // accounting of worker usage, nullptr when not monitored
+    static std::shared_ptr<Profiler> profiler; // profiler of the simulator's own performance, nullptr when not profiling
+    static std::shared_ptr<ActivityAccounting> activity_accounting; // simulation cost per job, nullptr when not accounted
+    static std::shared_ptr<ConvergenceMonitor> convergence_monitor; // steady-state detection and stop limits, nullptr when running to completion
+    static std::shared_ptr<StackDistanceAnalyzer> stack_distance_analyzer; // hit-ratio curves of the cache scopes, nullptr when not analyzed
+    static size_t num_simulated_activities; // reads, computations and writes performed by jobs
+    static size_t active_execution_controllers; // number of workload execution controllers, which have not finished yet
 
     // Cores required
     static int req_cores;
@@ -55,4 +76,6 @@ public:
     static std::ofstream filedump;
 };
 
+std::vector<JobSpecification> duplicateJobs(std::vector<JobSpecification>& workload, size_t duplications, std::set<std::shared_ptr<wrench::StorageService>> grid_storage_services);
+
 #endif //S_SIMPLESIMULATOR_H
@@ -0,0 +1,194 @@
+
+
+#include "StackDistanceAnalyzer.h"
+#include "util/Philox.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+
+/**
+ * @brief Construct the stack-distance analyzer
+ *
+ * @param sampling_rate Fraction of the files to sample, 1 for the exact analysis of all files
+ * @param num_points Number of equidistant capacities the hit-ratio curve is written at
+ *
+ * @throw std::invalid_argument
+ */
+StackDistanceAnalyzer::StackDistanceAnalyzer(double sampling_rate, size_t num_points) {
+    if (!(sampling_rate > 0. && sampling_rate <= 1.)) {
+        throw std::invalid_argument("StackDistanceAnalyzer(): The sampling rate has to be in (0, 1]!");
+    }
+    if (num_points == 0) {
+        throw std::invalid_argument("StackDistanceAnalyzer(): The hit-ratio curve needs at least one point!");
+    }
+    this->sampling_rate = sampling_rate;
+    this->sampling_threshold = sampling_rate >= 1. ? UINT64_MAX : static_cast<uint64_t>(sampling_rate * 18446744073709551616.);
+    this->num_points = num_points;
+}
+
+/**
+ * @brief Record an access to a file within a cache scope
+ *
+ * @param scope_name Name of the cache scope, the accessing job can reach
+ * @param file Accessed file
+ */
+void StackDistanceAnalyzer::access(const std::string& scope_name, const wrench::DataFile* file) {
+    auto& scope = this->scopes[scope_name];
+    scope.accesses++;
+    if (!this->isSampled(file)) {
+        return;
+    }
+    double size = file->getSize();
+    scope.sampled_accesses++;
+    scope.sampled_bytes += size;
+    auto it = scope.last_access.find(file);
+    if (it != scope.last_access.end()) {
+        size_t position = it->second;
+        // Bytes of the distinct files accessed after the previous access, plus the file itself
+        double distance = prefixSum(scope.tree, scope.next) - prefixSum(scope.tree, position + 1) + size;
+        scope.reuses.emplace_back(distance / this->sampling_rate, size);
+        add(scope.tree, position, -size);
+        scope.sizes[position] = 0.;
+        scope.files[position] = nullptr;
+    } else {
+        scope.footprint += size;
+    }
+    append(scope, file, size);
+}
+
+/**
+ * @brief Whether a file belongs to the spatial sample, decided by a hash of its ID
+ */
+bool StackDistanceAnalyzer::isSampled(const wrench::DataFile* file) const {
+    return this->sampling_threshold == UINT64_MAX || mix64(fnv1a_64(file->getID())) < this->sampling_threshold;
+}
+
+/**
+ * @brief Place a file at the next position as the most recently accessed one
+ */
+void StackDistanceAnalyzer::append(Scope& scope, const wrench::DataFile* file, double size) {
+    if (scope.next == scope.sizes.size()) {
+        rebuild(scope);
+    }
+    size_t position = scope.next++;
+    scope.files[position] = file;
+    scope.sizes[position] = size;
+    add(scope.tree, position, size);
+    scope.last_access[file] = position;
+}
+
+/**
+ * @brief Compact the positions to the files' last accesses keeping their order,
+ * leave room for at least as many accesses as there are distinct files and rebuild the Fenwick tree
+ */
+void StackDistanceAnalyzer::rebuild(Scope& scope) {
+    size_t capacity = std::max<size_t>(1024, 2 * scope.last_access.size());
+    std::vector<const wrench::DataFile*> files(capacity, nullptr);
+    std::vector<double> sizes(capacity, 0.);
+    size_t live = 0;
+    for (size_t p = 0; p < scope.next; p++) {
+        if (scope.files[p]) {
+            files[live] = scope.files[p];
+            sizes[live] = scope.sizes[p];
+            scope.last_access[scope.files[p]] = live;
+            live++;
+        }
+    }
+    // Linear-time construction of the Fenwick tree
+    std::vector<double> tree = sizes;
+    for (size_t i = 1; i <= capacity; i++) {
+        size_t parent = i + (i & (~i + 1));
+        if (parent <= capacity) {
+            tree[parent - 1] += tree[i - 1];
+        }
+    }
+    scope.files = std::move(files);
+    scope.sizes = std::move(sizes);
+    scope.tree = std::move(tree);
+    scope.next = live;
+}
+
+/**
+ * @brief Sum of the values at the positions [0, end)
+ */
+double StackDistanceAnalyzer::prefixSum(const std::vector<double>& tree, size_t end) {
+    double sum = 0.;
+    for (size_t i = end; i > 0; i -= i & (~i + 1)) {
+        sum += tree[i - 1];
+    }
+    return sum;
+}
+
+/**
+ * @brief Add a value at a position
+ */
+void StackDistanceAnalyzer::add(std::vector<double>& tree, size_t position, double value) {
+    for (size_t i = position + 1; i <= tree.size(); i += i & (~i + 1)) {
+        tree[i - 1] += value;
+    }
+}
+
+/**
+ * @brief Print the accesses, the footprint and the maximal hitrates per cache scope
+ *
+ * @param out Stream to print to
+ */
+void StackDistanceAnalyzer::print(std::ostream& out) const {
+    out << "Stack-distance analysis of " << this->scopes.size() << " cache scopes (sampling rate " << this->sampling_rate << ")" << std::endl;
+    for (const auto& [name, scope] : this->scopes) {
+        double reused_bytes = 0.;
+        for (const auto& reuse : scope.reuses) {
+            reused_bytes += reuse.second;
+        }
+        out << "\t" << name << ": " << scope.accesses << " accesses, footprint " << scope.footprint / this->sampling_rate << " bytes";
+        if (scope.sampled_accesses > 0) {
+            out << ", maximal hitrate " << static_cast<double>(scope.reuses.size()) / scope.sampled_accesses
+                << ", maximal byte hitrate " << reused_bytes / scope.sampled_bytes;
+        }
+        out << std::endl;
+    }
+}
+
+/**
+ * @brief Write the hit-ratio curve of every cache scope into a CSV file.
+ * The hitrate and byte hitrate of an LRU cache are given for equidistant capacities
+ * up to the largest stack distance, beyond which only cold misses remain.
+ *
+ * @param filename Path of the CSV file
+ *
+ * @throw std::runtime_error
+ */
+void StackDistanceAnalyzer::write(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Couldn't open hit-ratio curve file " + filename + " for dump!");
+    }
+    file << "cache.scope, cache.capacity, hitrate, bytehitrate\n";
+    for (const auto& [name, scope] : this->scopes) {
+        if (scope.sampled_accesses == 0) {
+            continue;
+        }
+        auto reuses = scope.reuses;
+        std::sort(reuses.begin(), reuses.end());
+        double max_distance = reuses.empty() ? 0. : reuses.back().first;
+        size_t hits = 0;
+        double hit_bytes = 0.;
+        auto reuse = reuses.begin();
+        for (size_t point = 0; point <= this->num_points; point++) {
+            double capacity = max_distance * point / this->num_points;
+            for (; reuse != reuses.end() && reuse->first <= capacity; ++reuse) {
+                hits++;
+                hit_bytes += reuse->second;
+            }
+            file << name << ", "
+                 << std::to_string(capacity) << ", "
+                 << std::to_string(static_cast<double>(hits) / scope.sampled_accesses) << ", "
+                 << std::to_string(hit_bytes / scope.sampled_bytes) << "\n";
+        }
+    }
+    if (!file.good()) {
+        throw std::runtime_error("Failed writing hit-ratio curve file " + filename + "!");
+    }
+}
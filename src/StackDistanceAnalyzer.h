@@ -0,0 +1,73 @@
+
+
+#ifndef S_STACKDISTANCEANALYZER_H
+#define S_STACKDISTANCEANALYZER_H
+
+#include <wrench-dev.h>
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Single-pass analysis of the input-file accesses per cache scope, which yields
+ * the hit-ratio curve of an LRU cache for all capacities at once (Mattson et al., 1970).
+ *
+ * The byte-weighted stack distance of an access is the total size of the distinct files
+ * accessed since the previous access of the same file, including the file itself:
+ * the access is a hit in every LRU cache at least this large. Distances are computed in
+ * logarithmic time with a Fenwick tree over the positions of the files' last accesses.
+ * To bound time and memory, files can be spatially sampled by a hash of their ID as in SHARDS
+ * (Waldspurger et al., FAST'15), the distances of the sampled files are scaled by the sampling rate.
+ * A scope holding several caches is analyzed as one cache of their combined capacity.
+ */
+class StackDistanceAnalyzer {
+public:
+    StackDistanceAnalyzer(double sampling_rate, size_t num_points);
+
+    void access(const std::string& scope_name, const wrench::DataFile* file);
+
+    void print(std::ostream& out) const;
+    void write(const std::string& filename) const;
+
+private:
+    /**
+     * @brief Access history and stack distances of a cache scope
+     */
+    struct Scope {
+        /** @brief position of the last access of every sampled file **/
+        std::unordered_map<const wrench::DataFile*, size_t> last_access;
+        /** @brief file and its size per position, nullptr and 0 when accessed again later **/
+        std::vector<const wrench::DataFile*> files;
+        std::vector<double> sizes;
+        /** @brief Fenwick tree of the sizes for prefix sums **/
+        std::vector<double> tree;
+        /** @brief next free position **/
+        size_t next = 0;
+
+        /** @brief scaled stack distance and size of every sampled re-access **/
+        std::vector<std::pair<double, double>> reuses;
+        size_t accesses = 0;
+        size_t sampled_accesses = 0;
+        double sampled_bytes = 0.;
+        /** @brief total size of the distinct sampled files **/
+        double footprint = 0.;
+    };
+
+    bool isSampled(const wrench::DataFile* file) const;
+    static void append(Scope& scope, const wrench::DataFile* file, double size);
+    static void rebuild(Scope& scope);
+    static double prefixSum(const std::vector<double>& tree, size_t end);
+    static void add(std::vector<double>& tree, size_t position, double value);
+
+    std::map<std::string, Scope> scopes;
+    double sampling_rate;
+    /** @brief files with a hash below the threshold are sampled **/
+    uint64_t sampling_threshold;
+    /** @brief number of capacities the hit-ratio curve is written at **/
+    size_t num_points;
+};
+
+#endif //S_STACKDISTANCEANALYZER_H
@@ -0,0 +1,154 @@
+
+
+#include "SummaryResultWriter.h"
+
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+
+/**
+ * @brief Update the statistics with a new value, NaN is ignored as by the t-digest
+ *
+ * @param value
+ */
+void RunningStatistics::add(double value) {
+    if (std::isnan(value)) return;
+    this->count++;
+    double delta = value - this->mean;
+    this->mean += delta / this->count;
+    this->m2 += delta * (value - this->mean);
+    this->min = std::min(this->min, value);
+    this->max = std::max(this->max, value);
+    this->digest.add(value);
+}
+
+/**
+ * @brief JSON representation of the statistics
+ *
+ * @return nlohmann::json
+ */
+nlohmann::json RunningStatistics::toJSON() {
+    nlohmann::json json;
+    json["count"] = this->count;
+    if (this->count == 0) {
+        return json;
+    }
+    json["mean"] = this->mean;
+    json["variance"] = this->count > 1 ? this->m2 / (this->count - 1) : 0.;
+    json["min"] = this->min;
+    json["max"] = this->max;
+    auto& quantiles = json["quantiles"];
+    for (auto q : {"0.01", "0.05", "0.1", "0.25", "0.5", "0.75", "0.9", "0.95", "0.99"}) {
+        quantiles[q] = this->digest.quantile(std::stod(q));
+    }
+    return json;
+}
+
+
+/**
+ * @brief Add a job record to the statistics of the group.
+ * Compute time and hitrate are left undefined (negative) for jobs without
+ * a monitored computation, e.g. calculation jobs, and are skipped then.
+ *
+ * @param record
+ */
+void SummaryResultWriter::GroupStatistics::add(const JobRecord& record) {
+    this->walltime.add(record.end_time - record.start_time);
+    this->queue_wait.add(record.queue_wait);
+    if (record.compute_time >= 0.) {
+        this->compute_time.add(record.compute_time);
+    }
+    this->io_stall_time.add(record.io_stall_time);
+    this->transfer_time.add(record.infile_transfer_time + record.outfile_transfer_time);
+    if (record.hitrate >= 0.) {
+        this->hitrate.add(record.hitrate);
+    }
+    this->bytes_read.add(record.infile_size);
+}
+
+nlohmann::json SummaryResultWriter::GroupStatistics::toJSON() {
+    return {
+        {"walltime", this->walltime.toJSON()},
+        {"queuewait", this->queue_wait.toJSON()},
+        {"computetime", this->compute_time.toJSON()},
+        {"iostalltime", this->io_stall_time.toJSON()},
+        {"transfertime", this->transfer_time.toJSON()},
+        {"hitrate", this->hitrate.toJSON()},
+        {"bytesread", this->bytes_read.toJSON()}
+    };
+}
+
+
+/**
+ * @brief Open the summary file
+ *
+ * @param filename Path of the output JSON file
+ * @param job_writer Writer for the per-job output, nullptr to disable it
+ * @param warmup Simulated time, before which completed jobs are excluded from the statistics
+ *
+ * @throw std::runtime_error
+ */
+SummaryResultWriter::SummaryResultWriter(const std::string& filename, std::shared_ptr<ResultWriter> job_writer, double warmup) : ResultWriter(filename) {
+    this->job_writer = job_writer;
+    this->warmup = warmup;
+    this->file.open(filename, std::ios::out | std::ios::trunc);
+    if (!this->file.is_open()) {
+        throw std::runtime_error("Couldn't open summary-file " + filename + " for dump!");
+    }
+}
+
+SummaryResultWriter::~SummaryResultWriter() {
+    try {
+        this->close();
+    } catch (std::exception& e) {
+        std::fprintf(stderr, "Exception while closing summary-file %s: %s\n", this->filename.c_str(), e.what());
+    }
+}
+
+/**
+ * @brief Update the statistics of the total, the job's workload and execution host
+ * unless the job completed during the warm-up, and pass the record on to the per-job output
+ *
+ * @param record Information about the completed job
+ */
+void SummaryResultWriter::write(const JobRecord& record) {
+    if (record.end_time >= this->warmup) {
+        this->total.add(record);
+        this->workloads[record.workload].add(record);
+        this->hosts[record.machine_name].add(record);
+    }
+    if (this->job_writer) {
+        this->job_writer->write(record);
+    }
+}
+
+/**
+ * @brief Write the statistics into the summary file and close the per-job output
+ *
+ * @throw std::runtime_error
+ */
+void SummaryResultWriter::close() {
+    if (!this->file.is_open()) {
+        return;
+    }
+    nlohmann::json summary;
+    summary["total"] = this->total.toJSON();
+    summary["workloads"] = nlohmann::json::object();
+    for (auto& [name, statistics] : this->workloads) {
+        summary["workloads"][name] = statistics.toJSON();
+    }
+    summary["hosts"] = nlohmann::json::object();
+    for (auto& [name, statistics] : this->hosts) {
+        summary["hosts"][name] = statistics.toJSON();
+    }
+    this->file << summary.dump(4) << std::endl;
+    bool failed = !this->file.good();
+    this->file.close();
+    if (this->job_writer) {
+        this->job_writer->close();
+    }
+    if (failed) {
+        throw std::runtime_error("Failed writing summary-file " + this->filename + "!");
+    }
+}
@@ -0,0 +1,71 @@
+
+
+#ifndef S_SUMMARYRESULTWRITER_H
+#define S_SUMMARYRESULTWRITER_H
+
+#include "ResultWriter.h"
+#include "util/TDigest.h"
+
+#include <fstream>
+#include <map>
+
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Streaming statistics of a single quantity:
+ * count, mean and variance (Welford's algorithm), extrema and t-digest quantiles
+ */
+class RunningStatistics {
+public:
+    void add(double value);
+    nlohmann::json toJSON();
+
+private:
+    size_t count = 0;
+    double mean = 0.;
+    double m2 = 0.;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    TDigest digest = TDigest(200.);
+};
+
+/**
+ * @brief Writer aggregating the job records per workload and per host into streaming statistics,
+ * which are written as JSON file when the writer is closed.
+ * Records are passed on to another writer for the per-job output, if one is given.
+ */
+class SummaryResultWriter : public ResultWriter {
+public:
+    SummaryResultWriter(const std::string& filename, std::shared_ptr<ResultWriter> job_writer, double warmup = 0.);
+    ~SummaryResultWriter() override;
+
+    void write(const JobRecord& record) override;
+    void close() override;
+
+private:
+    /**
+     * @brief Statistics of all monitored quantities for a group of jobs
+     */
+    struct GroupStatistics {
+        RunningStatistics walltime;
+        RunningStatistics queue_wait;
+        RunningStatistics compute_time;
+        RunningStatistics io_stall_time;
+        RunningStatistics transfer_time;
+        RunningStatistics hitrate;
+        RunningStatistics bytes_read;
+        void add(const JobRecord& record);
+        nlohmann::json toJSON();
+    };
+
+    std::shared_ptr<ResultWriter> job_writer;
+    std::ofstream file;
+    /** @brief jobs completed before the end of the warm-up are not summarized **/
+    double warmup;
+
+    GroupStatistics total;
+    std::map<std::string, GroupStatistics> workloads;
+    std::map<std::string, GroupStatistics> hosts;
+};
+
+#endif //S_SUMMARYRESULTWRITER_H
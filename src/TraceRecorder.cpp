@@ -0,0 +1,201 @@
+
+
+#include "TraceRecorder.h"
+
+#include <cstdio>
+#include <map>
+#include <set>
+#include <stdexcept>
+
+
+/**
+ * @brief Name, category and lane of the event types in the trace
+ */
+struct EventTypeInfo {
+    const char* name;
+    const char* category;
+    bool io_lane;
+};
+
+static EventTypeInfo eventTypeInfo(TraceRecorder::EventType type) {
+    switch (type) {
+        case TraceRecorder::EventType::JobSubmit:     return {"submit", "job", false};
+        case TraceRecorder::EventType::JobQueued:     return {"queued", "job", false};
+        case TraceRecorder::EventType::Job:           return {"job", "job", false};
+        case TraceRecorder::EventType::BlockRead:     return {"read block", "io", true};
+        case TraceRecorder::EventType::BlockCompute:  return {"compute block", "compute", false};
+        case TraceRecorder::EventType::FileRead:      return {"read file", "io", true};
+        case TraceRecorder::EventType::Compute:       return {"compute", "compute", false};
+        case TraceRecorder::EventType::OutputWrite:   return {"write output", "io", true};
+        case TraceRecorder::EventType::CacheEviction: return {"evict", "cache", true};
+    }
+    return {"unknown", "unknown", false};
+}
+
+/**
+ * @brief Write a string as JSON string literal
+ */
+static void writeJSONString(FILE* file, const std::string& s) {
+    std::fputc('"', file);
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            std::fputc('\\', file);
+            std::fputc(c, file);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            std::fprintf(file, "\\u%04x", c);
+        } else {
+            std::fputc(c, file);
+        }
+    }
+    std::fputc('"', file);
+}
+
+
+/**
+ * @brief Construct the recorder and preallocate the event buffer
+ *
+ * @param filename Path of the trace file written at the end
+ * @param capacity Maximal number of events kept in memory
+ *
+ * @throw std::invalid_argument
+ */
+TraceRecorder::TraceRecorder(const std::string& filename, size_t capacity) {
+    if (capacity == 0) {
+        throw std::invalid_argument("TraceRecorder(): The event buffer needs a capacity of at least one event!");
+    }
+    this->filename = filename;
+    this->capacity = capacity;
+    this->events.resize(capacity);
+}
+
+/**
+ * @brief Record an event spanning a time interval
+ *
+ * @param type Type of the event
+ * @param host Host the event happened on
+ * @param subject Job or file the event concerns
+ * @param start Simulated start time
+ * @param end Simulated end time
+ * @param amount Bytes or FLOPS processed
+ */
+void TraceRecorder::record(EventType type, const std::string& host, const std::string& subject, double start, double end, double amount) {
+    auto& event = this->events[this->num_recorded % this->capacity];
+    // The overwritten event no longer refers to its names
+    if (this->num_recorded >= this->capacity) {
+        this->release(event.host);
+        this->release(event.subject);
+    }
+    event = {start, end, amount, this->intern(host), this->intern(subject), type};
+    this->num_recorded++;
+}
+
+/**
+ * @brief Record an event happening at a point in time
+ */
+void TraceRecorder::instant(EventType type, const std::string& host, const std::string& subject, double time, double amount) {
+    this->record(type, host, subject, time, time, amount);
+}
+
+/**
+ * @brief Index of a name referred to by a new event, reusing the index of a released name if possible
+ */
+uint32_t TraceRecorder::intern(const std::string& name) {
+    auto it = this->name_indices.find(name);
+    if (it != this->name_indices.end()) {
+        this->references[it->second]++;
+        return it->second;
+    }
+    uint32_t index;
+    if (!this->free_indices.empty()) {
+        index = this->free_indices.back();
+        this->free_indices.pop_back();
+        this->names[index] = name;
+    } else {
+        index = this->names.size();
+        this->names.push_back(name);
+        this->references.push_back(0);
+    }
+    this->references[index] = 1;
+    this->name_indices.emplace(name, index);
+    return index;
+}
+
+/**
+ * @brief Drop a reference to a name, which is released once no event refers to it anymore
+ */
+void TraceRecorder::release(uint32_t index) {
+    if (--this->references[index] == 0) {
+        this->name_indices.erase(this->names[index]);
+        std::string().swap(this->names[index]);
+        this->free_indices.push_back(index);
+    }
+}
+
+/**
+ * @brief Serialize the recorded events into the trace file (Chrome trace event JSON)
+ *
+ * @throw std::runtime_error
+ */
+void TraceRecorder::write() {
+    FILE* file = std::fopen(this->filename.c_str(), "w");
+    if (!file) {
+        throw std::runtime_error("Couldn't open trace-file " + this->filename + " for dump!");
+    }
+
+    size_t num_kept = std::min(this->num_recorded, this->capacity);
+    size_t first = this->num_recorded - num_kept;
+
+    // Lanes within each host: one per job for computations, one per job for I/O,
+    // and a common one for cache operations
+    auto lane = [](const Event& event) -> uint64_t {
+        if (event.type == EventType::CacheEviction) return 0;
+        return 2 * static_cast<uint64_t>(event.subject) + (eventTypeInfo(event.type).io_lane ? 2 : 1);
+    };
+
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"recordedEvents\":%zu,\"droppedEvents\":%zu},\n\"traceEvents\":[\n", this->num_recorded, first);
+    std::map<uint32_t, std::set<std::pair<uint64_t, uint32_t>>> lanes_per_host;
+    bool first_line = true;
+    for (size_t i = first; i < this->num_recorded; i++) {
+        const auto& event = this->events[i % this->capacity];
+        auto info = eventTypeInfo(event.type);
+        uint64_t tid = lane(event);
+        lanes_per_host[event.host].insert({tid, event.subject});
+
+        std::fputs(first_line ? "" : ",\n", file);
+        first_line = false;
+        std::fprintf(file, "{\"name\":\"%s\",\"cat\":\"%s\",", info.name, info.category);
+        // Timestamps in microseconds of simulated time
+        if (event.end > event.start) {
+            std::fprintf(file, "\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,", event.start * 1e6, (event.end - event.start) * 1e6);
+        } else {
+            std::fprintf(file, "\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,", event.start * 1e6);
+        }
+        std::fprintf(file, "\"pid\":%u,\"tid\":%llu,\"args\":{\"subject\":", event.host, static_cast<unsigned long long>(tid));
+        writeJSONString(file, this->names[event.subject]);
+        std::fprintf(file, ",\"amount\":%.17g}}", event.amount);
+    }
+
+    // Metadata naming processes (hosts) and threads (lanes)
+    for (const auto& [host, lanes] : lanes_per_host) {
+        std::fprintf(file, "%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"args\":{\"name\":", first_line ? "" : ",\n", host);
+        first_line = false;
+        writeJSONString(file, this->names[host]);
+        std::fputs("}}", file);
+        for (const auto& [tid, subject] : lanes) {
+            std::fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%llu,\"args\":{\"name\":", host, static_cast<unsigned long long>(tid));
+            if (tid == 0) {
+                writeJSONString(file, "cache");
+            } else {
+                writeJSONString(file, this->names[subject] + (tid % 2 == 0 ? " I/O" : ""));
+            }
+            std::fputs("}}", file);
+        }
+    }
+    std::fputs("\n]}\n", file);
+
+    bool failed = std::ferror(file);
+    failed |= (std::fclose(file) != 0);
+    if (failed) {
+        throw std::runtime_error("Failed writing trace-file " + this->filename + "!");
+    }
+}
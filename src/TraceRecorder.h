@@ -0,0 +1,75 @@
+
+
+#ifndef S_TRACERECORDER_H
+#define S_TRACERECORDER_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Recorder of timeline events (job lifecycle, block reads and computations,
+ * cache evictions, output writes) for debugging the pipeline behavior.
+ *
+ * Events are stored in a preallocated ring buffer, which keeps the most recent events
+ * when it overflows. Host and subject names are interned with reference counts and released
+ * once no event in the buffer refers to them anymore, so memory stays bounded by the capacity.
+ * The events are serialized at the end of the simulation in the
+ * Chrome trace event JSON format, which can be opened with Perfetto or chrome://tracing.
+ * Every host is shown as process, every job has a lane for its computation and one for its I/O.
+ */
+class TraceRecorder {
+public:
+    enum class EventType : uint8_t {
+        JobSubmit,
+        JobQueued,
+        Job,
+        BlockRead,
+        BlockCompute,
+        FileRead,
+        Compute,
+        OutputWrite,
+        CacheEviction
+    };
+
+    TraceRecorder(const std::string& filename, size_t capacity);
+
+    void record(EventType type, const std::string& host, const std::string& subject, double start, double end, double amount = 0.);
+    void instant(EventType type, const std::string& host, const std::string& subject, double time, double amount = 0.);
+
+    void write();
+
+    const std::string& getFilename() const {
+        return this->filename;
+    }
+
+private:
+    struct Event {
+        double start;
+        double end;
+        /** @brief bytes read/written/evicted or FLOPS computed **/
+        double amount;
+        uint32_t host;
+        uint32_t subject;
+        EventType type;
+    };
+
+    uint32_t intern(const std::string& name);
+    void release(uint32_t index);
+
+    std::string filename;
+    std::vector<Event> events;
+    size_t capacity;
+    /** @brief total number of recorded events, the ring buffer holds the last capacity ones **/
+    size_t num_recorded = 0;
+
+    std::unordered_map<std::string, uint32_t> name_indices;
+    std::vector<std::string> names;
+    /** @brief number of events in the buffer referring to each name **/
+    std::vector<uint32_t> references;
+    /** @brief indices of released names for reuse **/
+    std::vector<uint32_t> free_indices;
+};
+
+#endif //S_TRACERECORDER_H
@@ -0,0 +1,164 @@
+
+
+#include "UtilizationMonitor.h"
+
+#include <wrench-dev.h>
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+
+/**
+ * @brief Construct the utilization monitor
+ *
+ * @param worker_hosts Hosts providing worker capacity, idle ones count into the site-wide capacity
+ * @param interval Resolution of the time series in simulated seconds
+ *
+ * @throw std::invalid_argument
+ */
+UtilizationMonitor::UtilizationMonitor(const std::set<std::string>& worker_hosts, double interval) {
+    if (interval <= 0.) {
+        throw std::invalid_argument("UtilizationMonitor(): The interval has to be positive!");
+    }
+    this->interval = interval;
+    for (const auto& hostname : worker_hosts) {
+        this->addHost(hostname);
+    }
+}
+
+/**
+ * @brief Register a host with its resources
+ */
+std::map<std::string, UtilizationMonitor::HostUsage>::iterator UtilizationMonitor::addHost(const std::string& hostname) {
+    HostUsage usage;
+    usage.available_cores = wrench::Simulation::getHostNumCores(hostname);
+    usage.available_memory = wrench::Simulation::getHostMemoryCapacity(hostname);
+    return this->hosts.emplace(hostname, std::move(usage)).first;
+}
+
+/**
+ * @brief Account the resources occupied by a job during its execution
+ *
+ * @param hostname Worker host executing the job
+ * @param start Start of the job's execution
+ * @param end End of the job's execution
+ * @param cores Number of cores occupied
+ * @param memory Memory occupied in bytes
+ */
+void UtilizationMonitor::addJob(const std::string& hostname, double start, double end, double cores, double memory) {
+    auto it = this->hosts.find(hostname);
+    if (it == this->hosts.end()) {
+        it = this->addHost(hostname);
+    }
+    auto& usage = it->second;
+    this->accumulate(usage.core_seconds, start, end, cores);
+    this->accumulate(usage.memory_seconds, start, end, memory);
+    usage.total_core_seconds += cores * (end - start);
+    usage.total_memory_seconds += memory * (end - start);
+    this->end_time = std::max(this->end_time, end);
+}
+
+/**
+ * @brief Add a constant usage over the interval [start, end] to the overlapping buckets
+ */
+void UtilizationMonitor::accumulate(std::vector<double>& buckets, double start, double end, double amount) const {
+    if (end <= start) return;
+    size_t first = static_cast<size_t>(start / this->interval);
+    size_t last = static_cast<size_t>(std::ceil(end / this->interval));
+    if (buckets.size() < last) {
+        buckets.resize(last, 0.);
+    }
+    for (size_t b = first; b < last; b++) {
+        double overlap = std::min(end, (b + 1) * this->interval) - std::max(start, b * this->interval);
+        if (overlap > 0.) {
+            buckets[b] += amount * overlap;
+        }
+    }
+}
+
+/**
+ * @brief Duration of a bucket, the last one ends with the last job
+ */
+double UtilizationMonitor::bucketDuration(size_t bucket) const {
+    return std::min(this->interval, this->end_time - bucket * this->interval);
+}
+
+/**
+ * @brief Write the time series of the average busy cores and used memory per host and site-wide,
+ * and the time-integrated utilization of every host
+ *
+ * @param timeseries_filename Path of the CSV file for the time series
+ * @param summary_filename Path of the CSV file for the integrated utilization, empty to skip it
+ *
+ * @throw std::runtime_error
+ */
+void UtilizationMonitor::write(const std::string& timeseries_filename, const std::string& summary_filename) const {
+    std::ofstream timeseries(timeseries_filename, std::ios::out | std::ios::trunc);
+    if (!timeseries.is_open()) {
+        throw std::runtime_error("Couldn't open utilization file " + timeseries_filename + " for dump!");
+    }
+    size_t num_buckets = static_cast<size_t>(std::ceil(this->end_time / this->interval));
+    double site_cores = 0., site_memory = 0.;
+    for (const auto& [hostname, usage] : this->hosts) {
+        site_cores += usage.available_cores;
+        site_memory += usage.available_memory;
+    }
+
+    timeseries << "time, machine.name, cores.busy, cores.available, memory.used, memory.available\n";
+    for (size_t b = 0; b < num_buckets; b++) {
+        double duration = this->bucketDuration(b);
+        if (duration <= 0.) continue;
+        double site_core_seconds = 0., site_memory_seconds = 0.;
+        for (const auto& [hostname, usage] : this->hosts) {
+            double core_seconds = b < usage.core_seconds.size() ? usage.core_seconds[b] : 0.;
+            double memory_seconds = b < usage.memory_seconds.size() ? usage.memory_seconds[b] : 0.;
+            site_core_seconds += core_seconds;
+            site_memory_seconds += memory_seconds;
+            timeseries << std::to_string(b * this->interval) << ", " << hostname << ", "
+                       << std::to_string(core_seconds / duration) << ", " << usage.available_cores << ", "
+                       << std::to_string(memory_seconds / duration) << ", " << std::to_string(usage.available_memory) << "\n";
+        }
+        timeseries << std::to_string(b * this->interval) << ", total, "
+                   << std::to_string(site_core_seconds / duration) << ", " << site_cores << ", "
+                   << std::to_string(site_memory_seconds / duration) << ", " << std::to_string(site_memory) << "\n";
+    }
+    if (!timeseries.good()) {
+        throw std::runtime_error("Failed writing utilization file " + timeseries_filename + "!");
+    }
+
+    // Utilization integrated from the simulation start to the end of the last job
+    double site_core_seconds = 0., site_memory_seconds = 0.;
+    for (const auto& [hostname, usage] : this->hosts) {
+        site_core_seconds += usage.total_core_seconds;
+        site_memory_seconds += usage.total_memory_seconds;
+    }
+    // Without any completed job or resources there is no time span to relate the usage to
+    auto utilization = [this](double used_seconds, double available) {
+        return available * this->end_time > 0. ? used_seconds / (available * this->end_time) : 0.;
+    };
+    double site_core_utilization = utilization(site_core_seconds, site_cores);
+    std::cerr << "Site-wide core utilization: " << site_core_utilization << " over " << this->end_time << " s" << std::endl;
+
+    if (summary_filename.empty()) {
+        return;
+    }
+    std::ofstream summary(summary_filename, std::ios::out | std::ios::trunc);
+    if (!summary.is_open()) {
+        throw std::runtime_error("Couldn't open utilization summary file " + summary_filename + " for dump!");
+    }
+    summary << "machine.name, cores.available, cores.utilization, memory.available, memory.utilization\n";
+    for (const auto& [hostname, usage] : this->hosts) {
+        summary << hostname << ", " << usage.available_cores << ", "
+                << utilization(usage.total_core_seconds, usage.available_cores) << ", "
+                << std::to_string(usage.available_memory) << ", "
+                << utilization(usage.total_memory_seconds, usage.available_memory) << "\n";
+    }
+    summary << "total, " << site_cores << ", " << site_core_utilization << ", "
+            << std::to_string(site_memory) << ", "
+            << utilization(site_memory_seconds, site_memory) << "\n";
+    if (!summary.good()) {
+        throw std::runtime_error("Failed writing utilization summary file " + summary_filename + "!");
+    }
+}
@@ -0,0 +1,51 @@
+
+
+#ifndef S_UTILIZATIONMONITOR_H
+#define S_UTILIZATIONMONITOR_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Online accounting of busy cores and used memory per worker host from the jobs' execution intervals.
+ * The step function of the resource usage is integrated on the fly into buckets of fixed simulated
+ * duration, which yields the downsampled time series of the average usage and the time-integrated
+ * utilization without keeping the individual jobs.
+ */
+class UtilizationMonitor {
+public:
+    UtilizationMonitor(const std::set<std::string>& worker_hosts, double interval);
+
+    void addJob(const std::string& hostname, double start, double end, double cores, double memory);
+
+    void write(const std::string& timeseries_filename, const std::string& summary_filename) const;
+
+private:
+    /**
+     * @brief Resources of a host and their usage integrated over time
+     */
+    struct HostUsage {
+        double available_cores;
+        double available_memory;
+        /** @brief busy core-seconds per bucket **/
+        std::vector<double> core_seconds;
+        /** @brief used byte-seconds of memory per bucket **/
+        std::vector<double> memory_seconds;
+        double total_core_seconds = 0.;
+        double total_memory_seconds = 0.;
+    };
+
+    std::map<std::string, HostUsage>::iterator addHost(const std::string& hostname);
+    void accumulate(std::vector<double>& buckets, double start, double end, double amount) const;
+    double bucketDuration(size_t bucket) const;
+
+    std::map<std::string, HostUsage> hosts;
+    /** @brief bucket duration in simulated seconds **/
+    double interval;
+    /** @brief end of the last job **/
+    double end_time = 0.;
+};
+
+#endif //S_UTILIZATIONMONITOR_H
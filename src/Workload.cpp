@@ -2,8 +2,12 @@
 
 #include "Workload.h"
 
+#include <thread>
+
 XBT_LOG_NEW_DEFAULT_CATEGORY(workload, "Log category for WorkloadExecutionController");
 
+unsigned int Workload::sampling_threads = 0;
+
 
 #define F(type) #type ,
 const char* workload_type_names[] = { WORKLOAD_TYPES( F ) nullptr };
@@ -42,7 +46,7 @@ std::string workload_type_to_string( WorkloadType workload )
  * @param workload_type: flag to specifiy, whether the job should run with streaming or not
  * @param name_suffix: part of job name to distinguish between different workloads
  * @param arrival_time: submission time offset relative to simulation start
- * @param generator: random number generator objects to draw from
+ * @param seed: master seed of the random streams the jobs are drawn from
  * 
  * @throw std::runtime_error
  */
@@ -56,57 +60,19 @@ Workload::Workload(
         const double average_outfile_size, const double sigma_outfile_size,
         const enum WorkloadType workload_type, const std::string name_suffix,
         const double arrival_time,
-        const std::mt19937& generator
+        const uint64_t seed
 ) {
-    this->generator = generator;
-    // Map to store the workload specification
-    std::vector<JobSpecification> batch;
-    std::string potential_separator = "_";
-    if(name_suffix == ""){
-        potential_separator = "";
-    }
-
-    // Initialize random number generators
-    std::normal_distribution<> flops_dist(average_flops, sigma_flops);
-    std::normal_distribution<> mem_dist(average_memory, sigma_memory);
-    std::normal_distribution<> insize_dist(average_infile_size, sigma_infile_size);
-    std::normal_distribution<> outsize_dist(average_outfile_size,sigma_outfile_size);
-
-    for (size_t j = 0; j < num_jobs; j++) {
-
-        // Create a job specification
-        JobSpecification job_specification;
-
-        // Set number of requested cores
-        job_specification.cores = request_cores;
-
-        // Sample strictly positive task flops
-        double dflops = flops_dist(this->generator);
-        while ((average_flops+sigma_flops) < dflops || dflops < 0.) dflops = flops_dist(this->generator);
-        job_specification.total_flops = dflops;
-
-        // Sample strictly positive task memory requirements
-        double dmem = mem_dist(this->generator);
-        while ((average_memory+sigma_memory) < dmem || dmem < 0.) dmem = mem_dist(this->generator);
-        job_specification.total_mem = dmem;
-
-        for (size_t f = 0; f < infiles_per_task; f++) {
-            // Sample inputfile sizes
-            double dinsize = insize_dist(this->generator);
-            while ((average_infile_size+3*sigma_infile_size) < dinsize || dinsize < 0.) dinsize = insize_dist(this->generator);
-            job_specification.infiles.push_back(wrench::Simulation::addFile("infile_" + name_suffix + potential_separator + std::to_string(j) + "_" + std::to_string(f), dinsize));
-        }
-
-        // Sample outfile sizes
-        double doutsize = outsize_dist(this->generator);
-        while ((average_outfile_size+3*sigma_outfile_size) < doutsize || doutsize < 0.) doutsize = outsize_dist(this->generator);
-        job_specification.outfile = wrench::Simulation::addFile("outfile_" + name_suffix + potential_separator + std::to_string(j), doutsize);
+    // Jobs are drawn from streams keyed by seed and workload name, independent of other workloads
+    this->stream_key = mix64(seed ^ mix64(fnv1a_64(name_suffix)));
 
-        job_specification.jobid = "job_" + name_suffix + potential_separator + std::to_string(j);
+    // Initialize random number generators, truncated to the physically sensible ranges
+    this->core_dist = IntSampler::constant(request_cores);
+    this->flops_dist = RealSampler::gaussian(average_flops, sigma_flops, 0., average_flops+sigma_flops);
+    this->mem_dist = RealSampler::gaussian(average_memory, sigma_memory, 0., average_memory+sigma_memory);
+    this->insize_dist = RealSampler::gaussian(average_infile_size, sigma_infile_size, 0., average_infile_size+3*sigma_infile_size);
+    this->outsize_dist = RealSampler::gaussian(average_outfile_size, sigma_outfile_size, 0., average_outfile_size+3*sigma_outfile_size);
 
-        batch.push_back(job_specification);
-    }
-    this->job_batch = batch;
+    this->sampleJobs(num_jobs, infiles_per_task, name_suffix);
     this->workload_type = workload_type;
     this->submit_arrival_time = arrival_time;
 }
@@ -126,7 +92,7 @@ Workload::Workload(
  * @param workload_type: flag to specifiy, whether the job should run with streaming or not
  * @param name_suffix: part of job name to distinguish between different workloads
  * @param arrival_time: submission time offset relative to simulation start
- * @param generator: random number generator objects to draw from
+ * @param seed: master seed of the random streams the jobs are drawn from
  * 
  * @throw std::runtime_error
  */
@@ -140,15 +106,10 @@ Workload::Workload(
         nlohmann::json outfile_size,
         const enum WorkloadType workload_type, const std::string name_suffix,
         const double arrival_time,
-        const std::mt19937& generator
+        const uint64_t seed
 ) {
-    this->generator = generator;
-    // Map to store the workload specification
-    std::vector<JobSpecification> batch;
-    std::string potential_separator = "_";
-    if(name_suffix == ""){
-        potential_separator = "";
-    }
+    // Jobs are drawn from streams keyed by seed and workload name, independent of other workloads
+    this->stream_key = mix64(seed ^ mix64(fnv1a_64(name_suffix)));
 
     // Initialize random number generators
     this->core_dist = Workload::initializeIntRNG(cores);
@@ -157,100 +118,155 @@ Workload::Workload(
     this->insize_dist = Workload::initializeDoubleRNG(infile_size);
     this->outsize_dist = Workload::initializeDoubleRNG(outfile_size);
 
-    for (size_t j = 0; j < num_jobs; j++) {
-        batch.push_back(sampleJob(j, infiles_per_job, name_suffix, potential_separator));
-    }
-
-    this->job_batch = batch;
+    this->sampleJobs(num_jobs, infiles_per_job, name_suffix);
     this->workload_type = workload_type;
     this->submit_arrival_time = arrival_time;
 }
 
 
-std::function<double(std::mt19937&)> Workload::initializeDoubleRNG(nlohmann::json json) {
-    // std::cerr << json["type"] << ": ";
-    std::function<double(std::mt19937&)> dist;
+/**
+ * @brief Create a Workload from already sampled job specifications, e.g. restored from a snapshot
+ * 
+ * @param job_batch job specifications
+ * @param workload_type flag to specifiy, whether the job should run with streaming or not
+ * @param arrival_time submission time offset relative to simulation start
+ */
+Workload::Workload(
+        std::vector<JobSpecification> job_batch,
+        const enum WorkloadType workload_type,
+        const double arrival_time
+) : job_batch(std::move(job_batch)), workload_type(workload_type), submit_arrival_time(arrival_time), stream_key(0) {}
+
+
+/**
+ * @brief Build the sampler for a real valued job characteristic from its json configuration.
+ * Only strictly positive values are drawn.
+ * 
+ * @param json json object containing type and parameters of the distribution
+ * @return RealSampler
+ * 
+ * @throw std::runtime_error
+ */
+RealSampler Workload::initializeDoubleRNG(const nlohmann::json& json) {
     if(json["type"].get<std::string>()=="gaussian") {
         double ave = json["average"].get<double>();
         double sigma = json["sigma"].get<double>();
-        // std::cerr << "ave: "<< ave << ", stddev: " << sigma << std::endl;
-        dist = [ave, sigma](std::mt19937& generator){
-            return std::normal_distribution<double>(ave, sigma)(generator);
-        };
+        return RealSampler::gaussian(ave, sigma, 0.);
     } else if(json["type"].get<std::string>()=="histogram") {
         auto bins = json["bins"].get<std::vector<double>>();
-        auto weights = json["counts"].get<std::vector<int>>();
-        // std::cerr << "bins: " << json["bins"] << ", weights: " << json["counts"] << std::endl;
-        dist = [bins, weights](std::mt19937& generator){
-            return std::piecewise_constant_distribution<double>(bins.begin(),bins.end(),weights.begin())(generator);
-        };
+        auto weights = json["counts"].get<std::vector<double>>();
+        return RealSampler::histogram(bins, weights, 0.);
     } else {
         throw std::runtime_error("Random number generation for type " + json["type"].get<std::string>() + " not implemented for real valued distributions!");
     }
-    return dist;
 }
 
-std::function<int(std::mt19937&)> Workload::initializeIntRNG(nlohmann::json json) {
-    // std::cerr << json["type"] << ": ";
-    std::function<int(std::mt19937&)> dist;
+/**
+ * @brief Build the sampler for an integer valued job characteristic from its json configuration.
+ * Only values of at least 1 are drawn.
+ * 
+ * @param json json object containing type and parameters of the distribution
+ * @return IntSampler
+ * 
+ * @throw std::runtime_error
+ */
+IntSampler Workload::initializeIntRNG(const nlohmann::json& json) {
     if(json["type"].get<std::string>()=="poisson") {
         int mu = json["mu"].get<int>();
-        // std::cerr << "ave: "<< ave << ", stddev: " << sigma << std::endl;
-        dist = [mu](std::mt19937& generator){
-            return std::poisson_distribution<int>(mu)(generator);
-        };
+        return IntSampler::poisson(mu, 1);
     } else if(json["type"].get<std::string>()=="histogram") {
-        try{
-            auto bins = json["bins"].get<std::vector<double>>();
+        if (json.contains("bins")) {
             WRENCH_WARN("Ignoring configured bins for integer distribution!");
         }
-        catch(...) {}
-        auto weights = json["counts"].get<std::vector<int>>();
-        // std::cerr << "bins: " << json["bins"] << ", weights: " << json["counts"] << std::endl;
-        dist = [weights](std::mt19937& generator){
-            return std::discrete_distribution<int>(weights.begin(), weights.end())(generator);
-        };
+        auto weights = json["counts"].get<std::vector<double>>();
+        return IntSampler::histogram(weights, 1);
     } else {
         throw std::runtime_error("Random number generation for type " + json["type"].get<std::string>() + " not implemented for integer valued distributions!");
     }
-    return dist;
 }
 
-
-JobSpecification Workload::sampleJob(size_t job_id, const size_t infiles_per_job, std::string name_suffix, std::string potential_separator) {
-    // Create a job specification
-    JobSpecification job_specification;
-
-    size_t j = job_id;
-
+/**
+ * @brief Sample the characteristics of a single job from the workload's distributions
+ * 
+ * @param job_specification job specification to fill the sampled characteristics into
+ * @param sizes sampled input-file sizes followed by the output-file size
+ * @param generator random stream of this job
+ */
+template <class URBG>
+void Workload::sampleJob(JobSpecification& job_specification, std::vector<double>& sizes, URBG& generator) const {
     // Sample number of cores to run on
-    int req_cores = this->core_dist(this->generator);
-    while (req_cores < 1) req_cores = this->core_dist(this->generator);
-    job_specification.cores = req_cores;
+    job_specification.cores = this->core_dist(generator);
 
     // Sample strictly positive task flops
-    double dflops = this->flops_dist(this->generator);
-    while (dflops < 0.) dflops = this->flops_dist(this->generator);
-    job_specification.total_flops = dflops;
+    job_specification.total_flops = this->flops_dist(generator);
 
     // Sample strictly positive task memory requirements
-    double dmem = this->mem_dist(this->generator);
-    while (dmem < 0.) dmem = this->mem_dist(this->generator);
-    job_specification.total_mem = dmem;
+    job_specification.total_mem = this->mem_dist(generator);
 
-    for (size_t f = 0; f < infiles_per_job; f++) {
-        // Sample strictly positive inputfile sizes
-        double dinsize = this->insize_dist(this->generator);
-        while (dinsize < 0.) dinsize = this->insize_dist(this->generator);
-        job_specification.infiles.push_back(wrench::Simulation::addFile("infile_" + name_suffix + potential_separator + std::to_string(j) + "_" + std::to_string(f), dinsize));
+    // Sample strictly positive inputfile sizes
+    for (size_t f = 0; f + 1 < sizes.size(); f++) {
+        sizes[f] = this->insize_dist(generator);
     }
 
     // Sample outfile sizes
-    double doutsize = this->outsize_dist(this->generator);
-    while (doutsize < 0.) doutsize = this->outsize_dist(this->generator);
-    job_specification.outfile = wrench::Simulation::addFile("outfile_" + name_suffix + potential_separator + std::to_string(j), doutsize);
+    sizes.back() = this->outsize_dist(generator);
+}
 
-    job_specification.jobid = "job_" + name_suffix + potential_separator + std::to_string(j);
+/**
+ * @brief Sample all jobs of the workload into the job batch.
+ * Every job draws from its own counter-based random stream keyed by its index,
+ * so the sampling is spread over threads without changing the outcome.
+ * Files are registered sequentially afterwards, as the simulation's file map is not thread-safe.
+ * 
+ * @param num_jobs number of jobs
+ * @param infiles_per_job number of input-files each job processes
+ * @param name_suffix part of job name to distinguish between different workloads
+ */
+void Workload::sampleJobs(const size_t num_jobs, const size_t infiles_per_job, const std::string& name_suffix) {
+    auto workload_tag = std::make_shared<const WorkloadTag>(WorkloadTag{name_suffix, num_jobs});
+    this->job_batch.clear();
+    this->job_batch.resize(num_jobs);
+    std::vector<double> infile_sizes(num_jobs * infiles_per_job);
+    std::vector<double> outfile_sizes(num_jobs);
+
+    auto sample_range = [&](size_t first, size_t last) {
+        std::vector<double> sizes(infiles_per_job + 1);
+        for (size_t j = first; j < last; j++) {
+            Philox4x32 job_generator(this->stream_key, j);
+            this->sampleJob(this->job_batch[j], sizes, job_generator);
+            std::copy(sizes.begin(), sizes.begin() + infiles_per_job, infile_sizes.begin() + j * infiles_per_job);
+            outfile_sizes[j] = sizes.back();
+        }
+    };
 
-    return job_specification;
+    unsigned int num_threads = Workload::sampling_threads;
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // Threads are only worth it for larger workloads
+    num_threads = std::min<size_t>(num_threads, std::max<size_t>(1, num_jobs / 1024));
+    if (num_threads <= 1) {
+        sample_range(0, num_jobs);
+    } else {
+        std::vector<std::thread> threads;
+        size_t chunk = (num_jobs + num_threads - 1) / num_threads;
+        for (size_t first = 0; first < num_jobs; first += chunk) {
+            threads.emplace_back(sample_range, first, std::min(num_jobs, first + chunk));
+        }
+        for (auto& t : threads) t.join();
+    }
+
+    // Create the files and identifiers of the jobs
+    for (size_t j = 0; j < num_jobs; j++) {
+        auto& job_specification = this->job_batch[j];
+        job_specification.jobid = JobID{workload_tag, j, 0};
+        std::string job_tag = job_specification.jobid.tag();
+        auto infiles = std::make_shared<FileList>();
+        infiles->reserve(infiles_per_job);
+        for (size_t f = 0; f < infiles_per_job; f++) {
+            infiles->push_back(wrench::Simulation::addFile("infile_" + job_tag + "_" + std::to_string(f), infile_sizes[j * infiles_per_job + f]));
+        }
+        job_specification.infiles = infiles;
+        job_specification.outfile = wrench::Simulation::addFile("outfile_" + job_tag, outfile_sizes[j]);
+    }
 }
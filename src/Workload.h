@@ -4,6 +4,8 @@
 
 #include "JobSpecification.h"
 #include "util/Utils.h"
+#include "util/Samplers.h"
+#include "util/Philox.h"
 
 // #include <variant>
 
@@ -63,7 +65,7 @@ class Workload {
             const double average_outfile_size, const double sigma_outfile_size,
             const WorkloadType workload_type, const std::string name_suffix,
             const double arrival_time,
-            const std::mt19937& generator
+            const uint64_t seed
         );
 
         Workload(
@@ -76,7 +78,13 @@ class Workload {
             nlohmann::json outfile_size,
             const WorkloadType workload_type, const std::string name_suffix,
             const double arrival_time,
-            const std::mt19937& generator
+            const uint64_t seed
+        );
+
+        Workload(
+            std::vector<JobSpecification> job_batch,
+            const WorkloadType workload_type,
+            const double arrival_time
         );
 
         // job list with specifications
@@ -86,19 +94,25 @@ class Workload {
         // time offset until job submission relative to simulation start time (0)
         double submit_arrival_time;
 
+        /** @brief number of threads used to sample jobs (0: use all hardware threads) **/
+        static unsigned int sampling_threads;
+
     private:
-        /** @brief generator to shuffle jobs **/
-        std::mt19937 generator;
-        std::function<int(std::mt19937&)> core_dist;
-        std::function<double(std::mt19937&)> flops_dist;
-        std::function<double(std::mt19937&)> mem_dist;
-        std::function<double(std::mt19937&)> insize_dist;
-        std::function<double(std::mt19937&)> outsize_dist;
-
-        std::function<int(std::mt19937&)> initializeIntRNG(nlohmann::json json);
-        std::function<double(std::mt19937&)> initializeDoubleRNG(nlohmann::json json);
-
-        JobSpecification sampleJob(const size_t job_id, const size_t infiles_per_job, std::string name_suffix, std::string potential_separator);
+        /** @brief key of the counter-based random streams, one stream per job **/
+        uint64_t stream_key;
+        /** @brief samplers for the job characteristics, constructed once per workload **/
+        IntSampler core_dist;
+        RealSampler flops_dist;
+        RealSampler mem_dist;
+        RealSampler insize_dist;
+        RealSampler outsize_dist;
+
+        static IntSampler initializeIntRNG(const nlohmann::json& json);
+        static RealSampler initializeDoubleRNG(const nlohmann::json& json);
+
+        template <class URBG>
+        void sampleJob(JobSpecification& job_specification, std::vector<double>& sizes, URBG& generator) const;
+        void sampleJobs(const size_t num_jobs, const size_t infiles_per_job, const std::string& name_suffix);
 };
 
 
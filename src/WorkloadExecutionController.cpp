@@ -9,6 +9,9 @@
  */
 #include <iostream>
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
 #include "util/DefaultValues.h"
 
 #include "WorkloadExecutionController.h"
@@ -29,9 +32,9 @@ XBT_LOG_NEW_DEFAULT_CATEGORY(simple_wms, "Log category for WorkloadExecutionCont
  *  @param grid_storage_services GRID storages holding files "for ever"
  *  @param cache_storage_services local caches evicting files when needed
  *  @param hostname host running the execution controller
- *  @param outputdump_name name of the file where the simulation's job information is stored
+ *  @param result_writer writer storing the simulation's job information
  *  @param shuffle_jobs switch to shuffle jobs for submission
- *  @param generator generator for job shuffling
+ *  @param generator random stream for job shuffling
  *  
  */
 WorkloadExecutionController::WorkloadExecutionController(
@@ -40,21 +43,20 @@ WorkloadExecutionController::WorkloadExecutionController(
         const std::set<std::shared_ptr<wrench::StorageService>>& grid_storage_services,
         const std::set<std::shared_ptr<wrench::StorageService>>& cache_storage_services,
         const std::string& hostname,
-        const std::string& outputdump_name,
-        const bool& shuffle_jobs, const std::mt19937& generator) : wrench::ExecutionController(
+        const std::shared_ptr<ResultWriter>& result_writer,
+        const bool& shuffle_jobs, const Philox4x32& generator) : wrench::ExecutionController(
         hostname,
-        "condor-simple") {
-    for (auto& job_spec: workload_spec.job_batch) {
-        this->workload_spec[job_spec.jobid] = job_spec;
-    }
+        "condor-simple"), generator(generator) {
+    this->workload_spec = workload_spec.job_batch;
     this->arrival_time = workload_spec.submit_arrival_time;
     this->workload_type = workload_spec.workload_type;
     this->htcondor_compute_services = htcondor_compute_services;
     this->grid_storage_services = grid_storage_services;
     this->cache_storage_services = cache_storage_services;
-    this->filename = outputdump_name;
+    this->result_writer = result_writer;
     this->shuffle_jobs = shuffle_jobs;
-    this->generator = generator;
+    this->profile_section = "controller " + this->getName();
+    SimpleSimulator::active_execution_controllers++;
 }
 
 /**
@@ -98,22 +100,26 @@ int WorkloadExecutionController::main() {
 
 
     // Shuffle jobs for submission
-    std::vector<const std::string*> job_spec_keys;
-    job_spec_keys.reserve(this->workload_spec.size());
-    for (const auto &job_name_spec: this->workload_spec) {
-        job_spec_keys.push_back(&(job_name_spec.first));
-    }
+    std::vector<size_t> job_spec_indices(this->workload_spec.size());
+    std::iota(job_spec_indices.begin(), job_spec_indices.end(), 0);
     if (this->shuffle_jobs){
-        std::shuffle(job_spec_keys.begin(), job_spec_keys.end(), generator);
+        std::shuffle(job_spec_indices.begin(), job_spec_indices.end(), generator);
     }
 
     // Create and submit all the jobs!
     WRENCH_INFO("There are %ld jobs to schedule at time %f", this->workload_spec.size(), this->arrival_time);
     wrench::Simulation::sleep(this->arrival_time);
-    for (auto job_name: job_spec_keys) {
-        auto job_spec = &this->workload_spec[*job_name];
+    if (this->stopRequested()) {
+        WRENCH_INFO("Simulation is stopping, skipping the submission of all jobs");
+        job_spec_indices.clear();
+    }
+    Profiler::Scope profile(SimpleSimulator::profiler, this->profile_section, "job creation and submission");
+    for (auto job_index: job_spec_indices) {
+        auto job_spec = &this->workload_spec[job_index];
+        std::string job_name = job_spec->jobid.str();
 
-        auto job = job_manager->createCompoundJob(*job_name);
+        auto job = job_manager->createCompoundJob(job_name);
+        this->pending_jobs[job.get()] = job_index;
 
         // Combined read-input-file-and-run-computation actions
         std::shared_ptr<MonitorAction> run_action;
@@ -126,7 +132,7 @@ int WorkloadExecutionController::main() {
             //? Split this into a caching file read and a standard compute action?
             // TODO: figure out what is the best value for the ability to parallelize HEP workloads on a CPU. Setting speedup to number of cores for now
             run_action = std::make_shared<MonitorAction>(
-                "copycompute_" + *job_name,
+                "copycompute_" + job_name,
                 job_spec->total_mem, job_spec->cores,
                 *copy_computation,
                 [](std::shared_ptr<wrench::ActionExecutor> action_executor) {
@@ -142,7 +148,7 @@ int WorkloadExecutionController::main() {
 
             // TODO: figure out what is the best value for the ability to parallelize HEP workloads on a CPU. Setting speedup to number of cores for now
             run_action = std::make_shared<MonitorAction>(
-                "streaming_" + *job_name,
+                "streaming_" + job_name,
                 job_spec->total_mem, job_spec->cores,
                 *streamed_computation,
                 [](std::shared_ptr<wrench::ActionExecutor> action_executor) {
@@ -155,7 +161,7 @@ int WorkloadExecutionController::main() {
         else if (this->workload_type == WorkloadType::Calculation) {
             // TODO: figure out what is the best value for the ability to parallelize HEP workloads on a CPU. Setting speedup to number of cores for now
             compute_action = job->addComputeAction(
-                "calculation_" + *job_name,
+                "calculation_" + job_name,
                 job_spec->total_flops, job_spec->total_mem,
                 job_spec->cores, job_spec->cores,
                 wrench::ParallelModel::CONSTANTEFFICIENCY(1.0)
@@ -167,12 +173,12 @@ int WorkloadExecutionController::main() {
 
         // Create the file write action
         auto fw_action = job->addFileWriteAction(
-            "file_write_" + *job_name,
+            "file_write_" + job_name,
             job_spec->outfile_destination
         );
         // //TODO: Think of a determination of storage_service to hold output data
         // // auto fw_action = job->addCustomAction(
-        // //     "file_write_" + *job_name,
+        // //     "file_write_" + job_name,
         // //     job_spec->total_mem, 0,
         // //     [](std::shared_ptr<wrench::ActionExecutor> action_executor) {
         // //         // TODO: Which storage service should we write output on?
@@ -196,10 +202,14 @@ int WorkloadExecutionController::main() {
 
         // Submit the job for execution!
         //TODO: generalize to arbitrary numbers of htcondor services
-        job_manager->submitJob(job, htcondor_compute_service);
+        profile.excluding([&]() { job_manager->submitJob(job, htcondor_compute_service); });
         WRENCH_INFO("Submitted job %s", job->getName().c_str());
+        if (SimpleSimulator::trace_recorder) {
+            SimpleSimulator::trace_recorder->instant(TraceRecorder::EventType::JobSubmit, this->getHostname(), job_name, wrench::Simulation::getCurrentSimulatedDate());
+        }
 
     }
+    profile.stop();
 
     WRENCH_INFO(
         "Job manager %s: Done with creation/submission of all compound jobs on host %s", 
@@ -208,16 +218,25 @@ int WorkloadExecutionController::main() {
 
 
     this->num_completed_jobs = 0;
-    while (this->workload_spec.size() > 0) {
-        // Wait for a workload execution event, and process it
+    while (!this->pending_jobs.empty()) {
+        // Wait for a workload execution event, and process it.
+        // When the simulation can be stopped early, wake up in time to check the stop conditions
         try {
-            this->waitForAndProcessNextEvent();
+            double timeout = std::numeric_limits<double>::infinity();
+            if (SimpleSimulator::convergence_monitor) {
+                timeout = std::max(0., SimpleSimulator::convergence_monitor->nextCheck() - wrench::Simulation::getCurrentSimulatedDate());
+            }
+            if (std::isfinite(timeout)) {
+                this->waitForAndProcessNextEvent(timeout);
+            } else {
+                this->waitForAndProcessNextEvent();
+            }
         } catch (wrench::ExecutionException &e) {
             WRENCH_INFO("Error while getting next execution event (%s)... ignoring and trying again", (e.getCause()->toString().c_str()));
             continue;
         }
 
-        if (this->abort || this->workload_spec.size() == 0) {
+        if (this->abort || this->pending_jobs.empty() || this->stopRequested()) {
             break;
         }
     }
@@ -225,8 +244,13 @@ int WorkloadExecutionController::main() {
     wrench::Simulation::sleep(10);
 
     WRENCH_INFO("--------------------------------------------------------");
-    if (this->workload_spec.size() == 0){
+    if (this->pending_jobs.empty()){
         WRENCH_INFO("Workload execution on %s is complete!", this->getHostname().c_str());
+    } else if (this->stopRequested()) {
+        WRENCH_INFO(
+            "Workload execution on %s stopped with %lu unfinished jobs: %s", this->getHostname().c_str(),
+            this->pending_jobs.size(), SimpleSimulator::convergence_monitor->getStopReason().c_str()
+        );
     } else{
         WRENCH_INFO("Workload execution on %s is incomplete!", this->getHostname().c_str());
     }
@@ -234,11 +258,27 @@ int WorkloadExecutionController::main() {
     WRENCH_INFO("WorkloadExecutionController daemon started on host %s terminating", wrench::Simulation::getHostName().c_str());
 
     this->job_manager.reset();
+    SimpleSimulator::active_execution_controllers--;
 
     return 0;
 }
 
 
+/**
+ * @brief Check whether the simulation shall be stopped early,
+ * after advancing the convergence monitor to the current simulated time
+ *
+ * @return true if the execution controller shall stop waiting for its jobs
+ */
+bool WorkloadExecutionController::stopRequested() {
+    if (!SimpleSimulator::convergence_monitor) {
+        return false;
+    }
+    SimpleSimulator::convergence_monitor->update(wrench::Simulation::getCurrentSimulatedDate());
+    return SimpleSimulator::convergence_monitor->shouldStop();
+}
+
+
 /**
  * @brief Process a ExecutionEvent::COMPOUND_JOB_FAILURE
  * Abort simulation once there is a failure.
@@ -261,11 +301,19 @@ void WorkloadExecutionController::processEventCompoundJobFailure(std::shared_ptr
 */
 void WorkloadExecutionController::processEventCompoundJobCompletion(std::shared_ptr<wrench::CompoundJobCompletedEvent> event) {
 
+    Profiler::Scope profile(SimpleSimulator::profiler, this->profile_section, "completion handling");
+
     /* Retrieve the job that this event is for */
     WRENCH_INFO("Notified that job %s with %ld actions has completed", event->job->getName().c_str(), event->job->getActions().size());
 
     this->num_completed_jobs++;
 
+    auto pending_job = this->pending_jobs.find(event->job.get());
+    if (pending_job == this->pending_jobs.end()) {
+        throw std::runtime_error("Completed job " + event->job->getName() + " is unknown to this execution controller!");
+    }
+    auto& job_spec = this->workload_spec[pending_job->second];
+
     /* Figure out execution host. All actions run on the same host, so let's just pick an arbitrary one */
     std::string execution_host = (*(event->job->getActions().begin()))->getExecutionHistory().top().physical_execution_host;
 
@@ -278,6 +326,11 @@ void WorkloadExecutionController::processEventCompoundJobCompletion(std::shared_
     double global_start_date = DBL_MAX;
     double global_end_date = DBL_MIN;
     double hitrate = DefaultValues::UndefinedDouble;
+    double io_stall_time = 0.;
+    double cached_infile_size = 0.;
+    double remote_infile_size = 0.;
+    double submit_date = event->job->getSubmitDate();
+    ActivityCounters activities;
 
     bool found_computation_action = false;
 
@@ -308,6 +361,10 @@ void WorkloadExecutionController::processEventCompoundJobCompletion(std::shared_
                 incr_infile_transfertime = monitor_action->get_infile_transfer_time();
                 incr_compute_time = monitor_action->get_calculation_time();
                 hitrate = monitor_action->get_hitrate();
+                io_stall_time = monitor_action->get_io_stall_time();
+                cached_infile_size = monitor_action->get_cached_data_size();
+                remote_infile_size = monitor_action->get_remote_data_size();
+                activities += monitor_action->get_activity_counters();
             } else {
                 throw std::runtime_error(
                     "Some of the job information for action " + monitor_action->getName() +
@@ -317,15 +374,21 @@ void WorkloadExecutionController::processEventCompoundJobCompletion(std::shared_
         } else if (auto file_write_action = std::dynamic_pointer_cast<wrench::FileWriteAction>(action)) {
             if (end_date >= start_date) {
                 incr_outfile_transfertime += end_date - start_date;
+                activities.writes++;
+                activities.messages += ActivityCounters::messagesPerTransfer(job_spec.outfile->getSize(), SimpleSimulator::storage_buffer_size);
+                if (SimpleSimulator::trace_recorder) {
+                    SimpleSimulator::trace_recorder->record(TraceRecorder::EventType::OutputWrite, execution_host, event->job->getName(), start_date, end_date, job_spec.outfile->getSize());
+                }
             } else {
                 throw std::runtime_error(
-                    "Writing outputfile " + this->workload_spec[event->job->getName()].outfile->getID() + 
+                    "Writing outputfile " + job_spec.outfile->getID() + 
                     " for job " + event->job->getName() + " finished before start!"
                 );
             }
         }
         else if (auto compute_action = std::dynamic_pointer_cast<wrench::ComputeAction>(action)) {
             if (end_date >= start_date) {
+                activities.execs++;
                 if(incr_compute_time == DefaultValues::UndefinedDouble){
                     incr_compute_time = end_date - start_date;
                 }
@@ -341,35 +404,53 @@ void WorkloadExecutionController::processEventCompoundJobCompletion(std::shared_
         }
     }
 
+    // Actions simulated by WRENCH itself, the computation actions count their own activities
+    SimpleSimulator::num_simulated_activities += event->job->getActions().size() - (found_computation_action ? 1 : 0);
+
     // Figure out file sizes
-    for (auto const &f : this->workload_spec[event->job->getName()].infiles) {
+    for (auto const &f : *job_spec.infiles) {
         incr_infile_size += f->getSize();
     }
-    incr_outfile_size += this->workload_spec[event->job->getName()].outfile->getSize();
+    incr_outfile_size += job_spec.outfile->getSize();
 
-    //? Remove job from containers like this?
-    this->workload_spec.erase(event->job->getName());
+    if (SimpleSimulator::convergence_monitor) {
+        SimpleSimulator::convergence_monitor->addJob(global_end_date, incr_infile_size, cached_infile_size);
+    }
 
-    /* Dump relevant information to file */
-    this->filedump.open(this->filename, ios::out | ios::app);
-    if (this->filedump.is_open()) {
-
-        this->filedump << event->job->getName() << ", "; 
-        // << std::to_string(job->getMinimumRequiredNumCores()) << ", " 
-        // << std::to_string(job->getMinimumRequiredMemory()) << ", " 
-        // << /*TODO: find a way to get disk usage on scratch space */ << ", ";
-        this->filedump << execution_host << ", " << hitrate << ", ";
-        this->filedump << std::to_string(global_start_date) << ", " << std::to_string(global_end_date) << ", ";
-        this->filedump << std::to_string(incr_compute_time) << ", ";
-        this->filedump << std::to_string(incr_infile_transfertime) << ", " << std::to_string(incr_infile_size) << ", " ;
-        this->filedump << std::to_string(incr_outfile_transfertime) << ", " << std::to_string(incr_outfile_size) << std::endl;
-
-        this->filedump.close();
-
-        WRENCH_INFO("Information for job %s has been dumped into file %s", event->job->getName().c_str(), this->filename.c_str());
+    if (SimpleSimulator::activity_accounting) {
+        SimpleSimulator::activity_accounting->addJob(event->job->getName(), job_spec.jobid.workload->name, workload_type_to_string(this->workload_type), activities);
+    }
+    if (SimpleSimulator::utilization_monitor) {
+        SimpleSimulator::utilization_monitor->addJob(execution_host, global_start_date, global_end_date, job_spec.cores, job_spec.total_mem);
     }
-    else {
-        throw std::runtime_error("Couldn't open output-file " + this->filename + " for dump!");
+    if (SimpleSimulator::trace_recorder) {
+        SimpleSimulator::trace_recorder->record(TraceRecorder::EventType::JobQueued, execution_host, event->job->getName(), submit_date, global_start_date);
+        SimpleSimulator::trace_recorder->record(TraceRecorder::EventType::Job, execution_host, event->job->getName(), global_start_date, global_end_date);
+    }
+
+    // Share of the input-file transfer time hidden behind computation
+    double overlap_fraction = 0.;
+    if (incr_infile_transfertime > 0.) {
+        overlap_fraction = std::max(0., 1. - io_stall_time / incr_infile_transfertime);
     }
 
+    // Release the job's files, they are not needed anymore
+    this->pending_jobs.erase(pending_job);
+    job_spec.infiles.reset();
+    job_spec.outfile.reset();
+    job_spec.outfile_destination.reset();
+
+    /* Dump relevant information to file */
+    // << std::to_string(job->getMinimumRequiredNumCores()) << ", " 
+    // << std::to_string(job->getMinimumRequiredMemory()) << ", " 
+    // << /*TODO: find a way to get disk usage on scratch space */ << ", ";
+    this->result_writer->write({
+        event->job->getName(), job_spec.jobid.workload->name, execution_host, hitrate,
+        submit_date, global_start_date, global_end_date, global_start_date - submit_date,
+        incr_compute_time, io_stall_time, overlap_fraction,
+        incr_infile_transfertime, incr_infile_size, cached_infile_size, remote_infile_size,
+        incr_outfile_transfertime, incr_outfile_size
+    });
+    WRENCH_INFO("Information for job %s has been dumped into file %s", event->job->getName().c_str(), this->result_writer->getFilename().c_str());
+
 }
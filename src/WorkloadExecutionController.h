@@ -13,12 +13,15 @@
 #include <wrench-dev.h>
 #include <iostream>
 #include <fstream>
+#include <unordered_map>
 
 #include "JobSpecification.h"
 #include "Workload.h"
 #include "LRU_FileList.h"
+#include "ResultWriter.h"
 
 #include "util/Utils.h"
+#include "util/Philox.h"
 
 class Simulation;
 
@@ -31,15 +34,15 @@ public:
               const std::set<std::shared_ptr<wrench::StorageService>>& grid_storage_services,
               const std::set<std::shared_ptr<wrench::StorageService>>& cache_storage_services,
               const std::string& hostname,
-              const std::string& outputdump_name,
-              const bool& shuffle_jobs, const std::mt19937& generator);
+              const std::shared_ptr<ResultWriter>& result_writer,
+              const bool& shuffle_jobs, const Philox4x32& generator);
 
-    std::map<std::string,JobSpecification>& get_workload_spec() {
+    std::vector<JobSpecification>& get_workload_spec() {
         return this->workload_spec;
     }
 
-    void set_workload_spec(std::map<std::string,JobSpecification> w) {
-        this->workload_spec = w;
+    void set_workload_spec(std::vector<JobSpecification> w) {
+        this->workload_spec = std::move(w);
     }
 
 
@@ -54,11 +57,16 @@ private:
     std::set<std::shared_ptr<wrench::StorageService>> cache_storage_services;
 
     /** @brief job batch to submit with all specs **/
-    std::map<std::string,JobSpecification> workload_spec;
+    std::vector<JobSpecification> workload_spec;
+
+    /** @brief submitted jobs, which have not completed yet, mapped to their index in the job batch **/
+    std::unordered_map<wrench::CompoundJob*, size_t> pending_jobs;
 
 
     int main() override;
 
+    bool stopRequested();
+
     /** @brief The job manager */
     std::shared_ptr<wrench::JobManager> job_manager;
     // /** @brief The data movement manager */
@@ -70,10 +78,8 @@ private:
 
     /** @brief Map holding information about the first and last task of jobs for output dump */
 //    std::map<std::shared_ptr<wrench::StandardJob>, std::pair<wrench::WorkloadTask*, wrench::WorkloadTask*>> job_first_last_tasks;
-    /** @brief Filename for the output-dump file */
-    std::string filename;
-    /** @brief Output filestream object to write out dump */
-    std::ofstream filedump;
+    /** @brief Process-wide writer of the output-dump */
+    std::shared_ptr<ResultWriter> result_writer;
 
     /** @brief number of complete jobs so far **/
     size_t num_completed_jobs = 0;
@@ -88,7 +94,10 @@ private:
     bool shuffle_jobs = false;
 
     /** @brief generator to shuffle jobs **/
-    std::mt19937 generator;
+    Philox4x32 generator;
+
+    /** @brief section of this controller in the profile **/
+    std::string profile_section;
 
 };
 
@@ -0,0 +1,256 @@
+
+
+#include "WorkloadSnapshot.h"
+
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(workload_snapshot, "Log category for WorkloadSnapshot");
+
+
+static const uint32_t endianness_tag = 0x01020304;
+
+/**
+ * @brief Round a byte offset up to the next multiple of 8
+ */
+static uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~uint64_t(7);
+}
+
+/**
+ * @brief Check whether a table of records lies within the file and is 8-byte aligned
+ */
+static bool tableInFile(uint64_t offset, uint64_t count, size_t record_size, size_t file_size) {
+    return offset % 8 == 0 && offset <= file_size && count <= (file_size - offset) / record_size;
+}
+
+/**
+ * @brief Check whether a slice of a table lies within the table
+ */
+static bool sliceInTable(uint64_t first, uint64_t count, uint64_t table_size) {
+    return first <= table_size && count <= table_size - first;
+}
+
+/**
+ * @brief Write all jobs and their files of the given workloads into a binary snapshot file
+ *
+ * @param workloads Workloads to store
+ * @param path Path of the snapshot file
+ *
+ * @throw std::runtime_error
+ */
+void WorkloadSnapshot::save(const std::vector<Workload>& workloads, const std::string& path) {
+    std::vector<WorkloadRecord> workload_records;
+    std::vector<JobRecord> job_records;
+    std::vector<FileRecord> file_records;
+    std::vector<uint64_t> infile_refs;
+    std::string strings;
+
+    // Catalog of unique files, identified by their object
+    std::unordered_map<const wrench::DataFile*, uint64_t> file_indices;
+    auto file_index = [&](const std::shared_ptr<wrench::DataFile>& file) {
+        auto it = file_indices.find(file.get());
+        if (it != file_indices.end()) {
+            return it->second;
+        }
+        uint64_t index = file_records.size();
+        file_records.push_back({strings.size(), file->getID().size(), file->getSize()});
+        strings += file->getID();
+        file_indices[file.get()] = index;
+        return index;
+    };
+
+    workload_records.reserve(workloads.size());
+    for (const auto& workload : workloads) {
+        WorkloadRecord workload_record = {};
+        if (!workload.job_batch.empty()) {
+            const auto& workload_tag = *workload.job_batch.front().jobid.workload;
+            workload_record.name_offset = strings.size();
+            workload_record.name_length = workload_tag.name.size();
+            workload_record.num_unique_jobs = workload_tag.num_jobs;
+            strings += workload_tag.name;
+        }
+        workload_record.first_job = job_records.size();
+        workload_record.num_jobs = workload.job_batch.size();
+        workload_record.submit_arrival_time = workload.submit_arrival_time;
+        workload_record.workload_type = static_cast<int32_t>(workload.workload_type);
+        workload_records.push_back(workload_record);
+        for (const auto& job : workload.job_batch) {
+            JobRecord record = {};
+            record.index = job.jobid.index;
+            record.replica = job.jobid.replica;
+            record.first_infile_ref = infile_refs.size();
+            record.num_infiles = job.infiles->size();
+            for (const auto& f : *job.infiles) {
+                infile_refs.push_back(file_index(f));
+            }
+            record.outfile = file_index(job.outfile);
+            record.total_flops = job.total_flops;
+            record.total_mem = job.total_mem;
+            record.cores = job.cores;
+            job_records.push_back(record);
+        }
+    }
+
+    Header header = {};
+    std::memcpy(header.magic, WorkloadSnapshot::magic, sizeof(header.magic));
+    header.version = WorkloadSnapshot::version;
+    header.endianness = endianness_tag;
+    header.num_workloads = workload_records.size();
+    header.num_jobs = job_records.size();
+    header.num_files = file_records.size();
+    header.num_infile_refs = infile_refs.size();
+    header.num_string_bytes = strings.size();
+    header.workloads_offset = align8(sizeof(Header));
+    header.jobs_offset = align8(header.workloads_offset + workload_records.size() * sizeof(WorkloadRecord));
+    header.files_offset = align8(header.jobs_offset + job_records.size() * sizeof(JobRecord));
+    header.infile_refs_offset = align8(header.files_offset + file_records.size() * sizeof(FileRecord));
+    header.strings_offset = align8(header.infile_refs_offset + infile_refs.size() * sizeof(uint64_t));
+
+    std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error("Couldn't open workload snapshot " + path + " for writing!");
+    }
+    auto write_at = [&out](uint64_t offset, const void* data, size_t size) {
+        static const char zeros[8] = {};
+        uint64_t position = out.tellp();
+        out.write(zeros, offset - position);
+        out.write(static_cast<const char*>(data), size);
+    };
+    write_at(0, &header, sizeof(Header));
+    write_at(header.workloads_offset, workload_records.data(), workload_records.size() * sizeof(WorkloadRecord));
+    write_at(header.jobs_offset, job_records.data(), job_records.size() * sizeof(JobRecord));
+    write_at(header.files_offset, file_records.data(), file_records.size() * sizeof(FileRecord));
+    write_at(header.infile_refs_offset, infile_refs.data(), infile_refs.size() * sizeof(uint64_t));
+    write_at(header.strings_offset, strings.data(), strings.size());
+    if (!out.good()) {
+        throw std::runtime_error("Failed writing workload snapshot " + path + "!");
+    }
+    WRENCH_INFO("Wrote %lu jobs with %lu files to workload snapshot %s", job_records.size(), file_records.size(), path.c_str());
+}
+
+/**
+ * @brief Restore the workloads stored in a binary snapshot file.
+ * The file is memory-mapped, all tables, references and strings are validated against its size,
+ * then the files of the catalog are added to the simulation.
+ *
+ * @param path Path of the snapshot file
+ * @return std::vector<Workload>
+ *
+ * @throw std::runtime_error
+ */
+std::vector<Workload> WorkloadSnapshot::load(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Couldn't open workload snapshot " + path + "!");
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || static_cast<size_t>(file_stat.st_size) < sizeof(Header)) {
+        close(fd);
+        throw std::runtime_error("Workload snapshot " + path + " is truncated!");
+    }
+    size_t file_size = file_stat.st_size;
+    void* mapping = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Couldn't map workload snapshot " + path + " into memory!");
+    }
+    const char* base = static_cast<const char*>(mapping);
+
+    std::vector<Workload> workloads;
+    try {
+        const Header& header = *reinterpret_cast<const Header*>(base);
+        if (std::memcmp(header.magic, WorkloadSnapshot::magic, sizeof(header.magic)) != 0 ||
+            header.version != WorkloadSnapshot::version || header.endianness != endianness_tag) {
+            throw std::runtime_error("File " + path + " is no compatible workload snapshot!");
+        }
+        if (!tableInFile(header.workloads_offset, header.num_workloads, sizeof(WorkloadRecord), file_size) ||
+            !tableInFile(header.jobs_offset, header.num_jobs, sizeof(JobRecord), file_size) ||
+            !tableInFile(header.files_offset, header.num_files, sizeof(FileRecord), file_size) ||
+            !tableInFile(header.infile_refs_offset, header.num_infile_refs, sizeof(uint64_t), file_size) ||
+            !tableInFile(header.strings_offset, header.num_string_bytes, 1, file_size)) {
+            throw std::runtime_error("Workload snapshot " + path + " is truncated!");
+        }
+        auto workload_records = reinterpret_cast<const WorkloadRecord*>(base + header.workloads_offset);
+        auto job_records = reinterpret_cast<const JobRecord*>(base + header.jobs_offset);
+        auto file_records = reinterpret_cast<const FileRecord*>(base + header.files_offset);
+        auto infile_refs = reinterpret_cast<const uint64_t*>(base + header.infile_refs_offset);
+        const char* strings = base + header.strings_offset;
+        // Validate all references before any file is added to the simulation
+        auto corrupt = std::runtime_error("Workload snapshot " + path + " is corrupt!");
+        for (uint64_t i = 0; i < header.num_files; i++) {
+            if (!sliceInTable(file_records[i].id_offset, file_records[i].id_length, header.num_string_bytes)) {
+                throw corrupt;
+            }
+        }
+        for (uint64_t w = 0; w < header.num_workloads; w++) {
+            const auto& record = workload_records[w];
+            if (!sliceInTable(record.name_offset, record.name_length, header.num_string_bytes) ||
+                !sliceInTable(record.first_job, record.num_jobs, header.num_jobs) ||
+                record.workload_type < 0 || record.workload_type >= NumWorkloadTypes) {
+                throw corrupt;
+            }
+        }
+        for (uint64_t j = 0; j < header.num_jobs; j++) {
+            const auto& record = job_records[j];
+            if (!sliceInTable(record.first_infile_ref, record.num_infiles, header.num_infile_refs) ||
+                record.outfile >= header.num_files) {
+                throw corrupt;
+            }
+        }
+        for (uint64_t r = 0; r < header.num_infile_refs; r++) {
+            if (infile_refs[r] >= header.num_files) {
+                throw corrupt;
+            }
+        }
+
+        std::vector<std::shared_ptr<wrench::DataFile>> files;
+        files.reserve(header.num_files);
+        for (uint64_t i = 0; i < header.num_files; i++) {
+            const auto& record = file_records[i];
+            files.push_back(wrench::Simulation::addFile(std::string(strings + record.id_offset, record.id_length), record.size));
+        }
+
+        workloads.reserve(header.num_workloads);
+        for (uint64_t w = 0; w < header.num_workloads; w++) {
+            const auto& workload_record = workload_records[w];
+            auto workload_tag = std::make_shared<const WorkloadTag>(WorkloadTag{
+                std::string(strings + workload_record.name_offset, workload_record.name_length),
+                workload_record.num_unique_jobs
+            });
+            std::vector<JobSpecification> job_batch(workload_record.num_jobs);
+            for (uint64_t j = 0; j < workload_record.num_jobs; j++) {
+                const auto& record = job_records[workload_record.first_job + j];
+                auto& job = job_batch[j];
+                job.jobid = JobID{workload_tag, record.index, record.replica};
+                auto infiles = std::make_shared<FileList>();
+                infiles->reserve(record.num_infiles);
+                for (uint64_t f = 0; f < record.num_infiles; f++) {
+                    infiles->push_back(files[infile_refs[record.first_infile_ref + f]]);
+                }
+                job.infiles = infiles;
+                job.outfile = files[record.outfile];
+                job.cores = record.cores;
+                job.total_flops = record.total_flops;
+                job.total_mem = record.total_mem;
+            }
+            workloads.push_back(Workload(
+                std::move(job_batch),
+                static_cast<WorkloadType>(workload_record.workload_type),
+                workload_record.submit_arrival_time
+            ));
+        }
+        WRENCH_INFO("Loaded %lu jobs with %lu files from workload snapshot %s", header.num_jobs, header.num_files, path.c_str());
+    } catch (...) {
+        munmap(mapping, file_size);
+        throw;
+    }
+    munmap(mapping, file_size);
+    return workloads;
+}
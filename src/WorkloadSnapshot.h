@@ -0,0 +1,72 @@
+
+
+#ifndef S_WORKLOADSNAPSHOT_H
+#define S_WORKLOADSNAPSHOT_H
+
+#include "Workload.h"
+
+#include <cstdint>
+
+/**
+ * @brief Compact binary snapshot of generated workloads (job batches and file catalog),
+ * to skip re-parsing and re-sampling when the same workloads are simulated repeatedly.
+ *
+ * The file consists of fixed-size, 8-byte aligned record tables addressed via offsets
+ * in the header, so it can be memory-mapped and read without any parsing step.
+ * Files shared between jobs are stored once and restored as the same file.
+ */
+class WorkloadSnapshot {
+public:
+    static void save(const std::vector<Workload>& workloads, const std::string& path);
+    static std::vector<Workload> load(const std::string& path);
+
+    static constexpr const char* magic = "DCSIMWL";
+    static constexpr uint32_t version = 2;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t endianness;
+        uint64_t num_workloads;
+        uint64_t num_jobs;
+        uint64_t num_files;
+        uint64_t num_infile_refs;
+        uint64_t num_string_bytes;
+        uint64_t workloads_offset;
+        uint64_t jobs_offset;
+        uint64_t files_offset;
+        uint64_t infile_refs_offset;
+        uint64_t strings_offset;
+    };
+
+    struct WorkloadRecord {
+        uint64_t name_offset;
+        uint64_t name_length;
+        uint64_t num_unique_jobs;
+        uint64_t first_job;
+        uint64_t num_jobs;
+        double submit_arrival_time;
+        int32_t workload_type;
+        int32_t padding;
+    };
+
+    struct JobRecord {
+        uint64_t index;
+        uint64_t replica;
+        uint64_t first_infile_ref;
+        uint64_t num_infiles;
+        uint64_t outfile;
+        double total_flops;
+        double total_mem;
+        int32_t cores;
+        int32_t padding;
+    };
+
+    struct FileRecord {
+        uint64_t id_offset;
+        uint64_t id_length;
+        double size;
+    };
+};
+
+#endif //S_WORKLOADSNAPSHOT_H
@@ -5,6 +5,8 @@ XBT_LOG_NEW_DEFAULT_CATEGORY(cache_computation, "Log category for CacheComputati
 #include "CacheComputation.h"
 #include "../MonitorAction.h"
 
+#include <algorithm>
+
 //#define SIMULATE_FILE_LOOKUP_OPERATION 1
 
 
@@ -19,13 +21,13 @@ XBT_LOG_NEW_DEFAULT_CATEGORY(cache_computation, "Log category for CacheComputati
  */
 CacheComputation::CacheComputation(std::set<std::shared_ptr<wrench::StorageService>> &cache_storage_services,
                                 std::set<std::shared_ptr<wrench::StorageService>> &grid_storage_services,
-                                std::vector<std::shared_ptr<wrench::DataFile>> &files,
+                                std::shared_ptr<const FileList> files,
                                 double total_flops) {
     this->cache_storage_services = cache_storage_services;
     this->grid_storage_services = grid_storage_services;
-    this->files = files;
+    this->files = std::move(files);
     this->total_flops = total_flops;
-    this->total_data_size = determineTotalDataSize(files);
+    this->total_data_size = determineTotalDataSize(*this->files);
 }
 
 /**
@@ -40,10 +42,15 @@ CacheComputation::CacheComputation(std::set<std::shared_ptr<wrench::StorageServi
  */
 void CacheComputation::determineFileSourcesAndCache(std::shared_ptr<wrench::ActionExecutor> action_executor, bool cache_files = true) {
 
+    Profiler::Scope profile(SimpleSimulator::profiler, "computation", "source determination");
+
     std::string hostname = action_executor->getHostname(); // host where action is executed
     auto host = simgrid::s4u::Host::by_name(hostname); 
     std::string netzone = host->get_englobing_zone()->get_name(); // network zone executing host belongs to
     auto the_action = std::dynamic_pointer_cast<MonitorAction>(action_executor->getAction()); // executed action
+    auto& activities = the_action->get_activity_counters();
+    // Choice of the caching destinations, drawn from a stream of the job independent of the other jobs
+    auto destination_choice = SimpleSimulator::randomStream("cache-destination", the_action->getJob()->getName());
 
     double cached_data_size = 0.;
     double remote_data_size = 0.;
@@ -67,65 +74,81 @@ void CacheComputation::determineFileSourcesAndCache(std::shared_ptr<wrench::Acti
     if (matched_storage_services.empty()) {
         WRENCH_DEBUG("Couldn't find a reachable cache");
     }
+
+    // Scope of the reachable caches, named by their sorted hosts, for the analysis of its access stream
+    std::string analyzed_scope;
+    if (SimpleSimulator::stack_distance_analyzer && !matched_storage_services.empty()) {
+        std::vector<std::string> cache_hosts;
+        for (auto const &ss : matched_storage_services) {
+            cache_hosts.push_back(ss->getHostname());
+        }
+        std::sort(cache_hosts.begin(), cache_hosts.end());
+        for (auto const &cache_host : cache_hosts) {
+            analyzed_scope += (analyzed_scope.empty() ? "" : "+") + cache_host;
+        }
+    }
     
 
     // For each file, identify where to read it from and/or deal with cache updates, etc.
-    for (auto const &f : this->files) {
+    for (auto const &f : *this->files) {
+        if (!analyzed_scope.empty()) {
+            SimpleSimulator::stack_distance_analyzer->access(analyzed_scope, f.get());
+        }
         // find a source providing the required file
-        std::shared_ptr<wrench::StorageService> source_ss;
         // See whether the file is already available in a "reachable" cache storage service
-        for (auto const &ss : matched_storage_services) {
-#ifdef SIMULATE_FILE_LOOKUP_OPERATION
-            bool has_file = ss->lookupFile(f, wrench::FileLocation::LOCATION(ss));
-#else
-            bool has_file = SimpleSimulator::global_file_map[ss].hasFile(f);
-#endif
-            if (has_file) {
-                source_ss = ss;
-                WRENCH_DEBUG("Found file %s with size %.2f in cache %s", f->getID().c_str(), f->getSize(), source_ss->getHostname().c_str());
-                cached_data_size += f->getSize();
-                break;
-            }
-        }
+        std::shared_ptr<wrench::StorageService> source_ss = lookupFile(f, matched_storage_services);
         // If yes, we're done
         if (source_ss) {
+            WRENCH_DEBUG("Found file %s with size %.2f in cache %s", f->getID().c_str(), f->getSize(), source_ss->getHostname().c_str());
+            cached_data_size += f->getSize();
+            SimpleSimulator::global_file_map[source_ss].recordHit();
             SimpleSimulator::global_file_map[source_ss].touchFile(f.get());
             this->file_sources[f] = wrench::FileLocation::LOCATION(source_ss, f);
             continue;
         }
         // If not, then we have to copy the file from some GRID source to some reachable cache storage service
         // TODO: Find the optimal GRID source, whatever that means (right now it's whichever one works first)
-        for (auto const &ss : this->grid_storage_services) {
-#ifdef SIMULATE_FILE_LOOKUP_OPERATION
-            bool has_file = ss->lookupFile(f, wrench::FileLocation::LOCATION(ss));
-#else
-            bool has_file = SimpleSimulator::global_file_map[ss].hasFile(f);
-#endif
-            if (has_file) {
-                source_ss = ss;
-                remote_data_size += f->getSize();
-                break;
+        if (SimpleSimulator::origin_storage && !this->grid_storage_services.empty()) {
+            // Origin storages hold all files implicitly, so there is nothing to look up.
+            // The file is only materialized on the origin when it is accessed for the first time.
+            source_ss = *this->grid_storage_services.begin();
+            // Origins never evict, hence no LRU bookkeeping is needed for them.
+            if (SimpleSimulator::origin_materialized_files[source_ss].insert(f.get()).second) {
+                wrench::StorageService::createFileAtLocation(wrench::FileLocation::LOCATION(source_ss, f));
+                activities.file_creations++;
             }
-        }
-        if (!source_ss) {
-            throw std::runtime_error("CacheComputation(): Couldn't find file " + f->getID() + " on any storage service!");
+            remote_data_size += f->getSize();
         } else {
-            SimpleSimulator::global_file_map[source_ss].touchFile(f.get());
+            source_ss = lookupFile(f, this->grid_storage_services);
+            if (!source_ss) {
+                throw std::runtime_error("CacheComputation(): Couldn't find file " + f->getID() + " on any storage service!");
+            } else {
+                remote_data_size += f->getSize();
+                SimpleSimulator::global_file_map[source_ss].touchFile(f.get());
+            }
         }
 
         // When there is a reachable cache, cache the file and evict others when needed
         if (!matched_storage_services.empty()) {
             // Destination storage to cache the file
-            // TODO: Find the optimal reachable cache destination, whatever that means (right now it's random, with a bad RNG!)
-            auto destination_ss = matched_storage_services.at(rand() % matched_storage_services.size());
+            // TODO: Find the optimal reachable cache destination, whatever that means (right now it's random)
+            auto destination_ss = matched_storage_services.at(destination_choice() % matched_storage_services.size());
+            SimpleSimulator::global_file_map[destination_ss].recordMiss();
 
             // Evict files while to create space, using an LRU scheme!
-            double free_space = destination_ss->getTotalFreeSpace();
+            double free_space = 0.;
+            profile.excluding([&]() { free_space = destination_ss->getTotalFreeSpace(); });
+            activities.messages += 2;
             while (free_space < f->getSize()) {
                 auto to_evict = SimpleSimulator::global_file_map[destination_ss].removeLRUFile();
                 WRENCH_INFO("Evicting file %s from storage service on host %s",
                             to_evict->getID().c_str(), destination_ss->getHostname().c_str());
-                destination_ss->deleteFile(wrench::FileLocation::LOCATION(destination_ss, to_evict));
+                profile.excluding([&]() { destination_ss->deleteFile(wrench::FileLocation::LOCATION(destination_ss, to_evict)); });
+                activities.file_deletions++;
+                activities.messages += 2;
+                if (SimpleSimulator::trace_recorder) {
+                    SimpleSimulator::trace_recorder->instant(TraceRecorder::EventType::CacheEviction, destination_ss->getHostname(), to_evict->getID(), wrench::Simulation::getCurrentSimulatedDate(), to_evict->getSize());
+                }
                 free_space += to_evict->getSize();
             }
 
@@ -140,6 +163,7 @@ void CacheComputation::determineFileSourcesAndCache(std::shared_ptr<wrench::Acti
                 WRENCH_DEBUG("Caching file %s on storage %s", f->getID().c_str(), destination_ss->getHostname().c_str());
                 // wrench::StorageService::copyFile(f, wrench::FileLocation::LOCATION(source_ss), wrench::FileLocation::LOCATION(destination_ss));
                 wrench::StorageService::createFileAtLocation(wrench::FileLocation::LOCATION(destination_ss, f));
+                activities.file_creations++;
 
                 SimpleSimulator::global_file_map[destination_ss].touchFile(f.get());
 
@@ -157,8 +181,35 @@ void CacheComputation::determineFileSourcesAndCache(std::shared_ptr<wrench::Acti
     }
     WRENCH_DEBUG("Hitrate: %.2f (Cached data: %.2f, total data: %.2f)", cached_data_size/this->total_data_size, cached_data_size, this->total_data_size);
     the_action->set_hitrate(cached_data_size/this->total_data_size);
+    the_action->set_cached_data_size(cached_data_size);
+    the_action->set_remote_data_size(remote_data_size);
+}
+
+/**
+ * @brief Find the first of the given storage services holding a file
+ * 
+ * @param file File to look for
+ * @param storage_services Storage services to search in order
+ * @return std::shared_ptr<wrench::StorageService>, nullptr if none holds the file
+ */
+template <class StorageServices>
+std::shared_ptr<wrench::StorageService> CacheComputation::lookupFile(const std::shared_ptr<wrench::DataFile>& file, const StorageServices& storage_services) {
+#ifdef SIMULATE_FILE_LOOKUP_OPERATION
+    for (auto const &ss : storage_services) {
+        if (ss->lookupFile(file, wrench::FileLocation::LOCATION(ss))) {
+            return ss;
+        }
+    }
+    return nullptr;
+#else
+    auto ss = lookupFile(file, storage_services, SimpleSimulator::global_file_map);
+    return ss ? *ss : nullptr;
+#endif
 }
 
+template std::shared_ptr<wrench::StorageService> CacheComputation::lookupFile(const std::shared_ptr<wrench::DataFile>&, const std::vector<std::shared_ptr<wrench::StorageService>>&);
+template std::shared_ptr<wrench::StorageService> CacheComputation::lookupFile(const std::shared_ptr<wrench::DataFile>&, const std::set<std::shared_ptr<wrench::StorageService>>&);
+
 //? Question for Henri: put this into determineFileSources function to prevent two times the same loop?
 /**
  * @brief Determine the incremental size of all input-files of a job
@@ -166,9 +217,9 @@ void CacheComputation::determineFileSourcesAndCache(std::shared_ptr<wrench::Acti
  * @param files Input files of the job to consider
  * @return double
  */
-double CacheComputation::determineTotalDataSize(const std::vector<std::shared_ptr<wrench::DataFile>> &files) {
+double CacheComputation::determineTotalDataSize(const FileList &files) {
     double incr_file_size = 0.0;
-    for (auto const &f : this->files) {
+    for (auto const &f : files) {
         incr_file_size += f->getSize();
     }
     return incr_file_size;
@@ -13,7 +13,7 @@ public:
     CacheComputation(
         std::set<std::shared_ptr<wrench::StorageService>> & cache_storage_services,
         std::set<std::shared_ptr<wrench::StorageService>> & grid_storage_services,
-        std::vector<std::shared_ptr<wrench::DataFile>> &files,
+        std::shared_ptr<const FileList> files,
         double total_flops
     );
 
@@ -25,17 +25,38 @@ public:
 
     double determineFlops(double data_size, double total_data_size);
 
+    template <class StorageServices>
+    static std::shared_ptr<wrench::StorageService> lookupFile(const std::shared_ptr<wrench::DataFile>& file, const StorageServices& storage_services);
+
+    /**
+     * @brief Find the first of the given keys, whose file collection in a file map holds a file
+     *
+     * @param file File to look for
+     * @param keys Keys of the file collections to search in order
+     * @param file_map File collections by key
+     * @return const Key*, pointing into keys, nullptr if no collection holds the file
+     */
+    template <class Key, class Keys>
+    static const Key* lookupFile(const std::shared_ptr<wrench::DataFile>& file, const Keys& keys, std::map<Key, LRU_FileList>& file_map) {
+        for (auto const &key : keys) {
+            if (file_map[key].hasFile(file)) {
+                return &key;
+            }
+        }
+        return nullptr;
+    }
+
     virtual void performComputation(std::shared_ptr<wrench::ActionExecutor> action_executor) = 0;
 
 protected:
     std::set<std::shared_ptr<wrench::StorageService>> cache_storage_services;
     std::set<std::shared_ptr<wrench::StorageService>> grid_storage_services;
-    std::vector<std::shared_ptr<wrench::DataFile>> files; //? does this need to be ordered?
+    std::shared_ptr<const FileList> files; //? does this need to be ordered?
     double total_flops;
 
     std::map<std::shared_ptr<wrench::DataFile>, std::shared_ptr<wrench::FileLocation>> file_sources;
 
-    double determineTotalDataSize(const std::vector<std::shared_ptr<wrench::DataFile>> &files);
+    double determineTotalDataSize(const FileList &files);
     double total_data_size;
 };
 
@@ -17,7 +17,7 @@ XBT_LOG_NEW_DEFAULT_CATEGORY(copy_computation, "Log category for CopyComputation
 CopyComputation::CopyComputation(
     std::set<std::shared_ptr<wrench::StorageService>> &cache_storage_services,
     std::set<std::shared_ptr<wrench::StorageService>> &grid_storage_services,
-    std::vector<std::shared_ptr<wrench::DataFile>> &files,
+    std::shared_ptr<const FileList> files,
     double total_flops) : CacheComputation::CacheComputation(
         cache_storage_services,
         grid_storage_services,
@@ -34,10 +34,19 @@ CopyComputation::CopyComputation(
 void CopyComputation::performComputation(std::shared_ptr<wrench::ActionExecutor> action_executor) {
 
     auto the_action = std::dynamic_pointer_cast<MonitorAction>(action_executor->getAction()); // executed action
+    auto& activities = the_action->get_activity_counters();
 
     double infile_transfer_time = 0.;
     double compute_time = 0.;
 
+    // Optional recording of the file read timeline
+    auto trace = SimpleSimulator::trace_recorder;
+    std::string hostname = trace ? action_executor->getHostname() : "";
+    std::string job_name = trace ? the_action->getJob()->getName() : "";
+
+    // Bookkeeping of the file copies, the simulated reads and computation are excluded
+    Profiler::Scope profile(SimpleSimulator::profiler, "computation", "file copies");
+
     WRENCH_INFO("Performing copy computation!");
     // Incremental size of all input files to process
     double total_data_size = this->total_data_size;
@@ -48,10 +57,15 @@ void CopyComputation::performComputation(std::shared_ptr<wrench::ActionExecutor>
                     fs.first->getID().c_str(), fs.second->getStorageService()->getHostname().c_str());
 
         double read_start_time = wrench::Simulation::getCurrentSimulatedDate();
-        fs.second->getStorageService()->readFile(fs.second);
+        profile.excluding([&]() { fs.second->getStorageService()->readFile(fs.second); });
         double read_end_time = wrench::Simulation::getCurrentSimulatedDate();
 
         data_size += fs.first->getSize();
+        activities.reads++;
+        activities.messages += ActivityCounters::messagesPerTransfer(fs.first->getSize(), SimpleSimulator::storage_buffer_size);
+        if (trace) {
+            trace->record(TraceRecorder::EventType::FileRead, hostname, job_name, read_start_time, read_end_time, fs.first->getSize());
+        }
         if (read_end_time >= read_start_time) {
             infile_transfer_time += read_end_time - read_start_time;
         } else {
@@ -66,10 +80,15 @@ void CopyComputation::performComputation(std::shared_ptr<wrench::ActionExecutor>
 
     // Perform the computation as needed
     double flops = determineFlops(data_size, total_data_size);
+    SimpleSimulator::num_simulated_activities += this->file_sources.size() + 1;
+    activities.execs++;
     WRENCH_INFO("Computing %.2lf flops", flops);
     double compute_start_time = wrench::Simulation::getCurrentSimulatedDate();
-    wrench::Simulation::compute(flops);
+    profile.excluding([&]() { wrench::Simulation::compute(flops); });
     double compute_end_time = wrench::Simulation::getCurrentSimulatedDate();
+    if (trace) {
+        trace->record(TraceRecorder::EventType::Compute, hostname, job_name, compute_start_time, compute_end_time, flops);
+    }
 
     if (compute_end_time > compute_start_time) {
         compute_time += compute_end_time - compute_start_time;
@@ -82,5 +101,7 @@ void CopyComputation::performComputation(std::shared_ptr<wrench::ActionExecutor>
     // Fill monitoring information
     the_action->set_infile_transfer_time(infile_transfer_time);
     the_action->set_calculation_time(compute_time);
+    // Reading and computation are strictly sequential, the computation waits for every read
+    the_action->set_io_stall_time(infile_transfer_time);
 }
 
@@ -20,7 +20,7 @@ XBT_LOG_NEW_DEFAULT_CATEGORY(streamed_computation, "Log category for StreamedCom
 StreamedComputation::StreamedComputation(
     std::set<std::shared_ptr<wrench::StorageService>> &cache_storage_services,
     std::set<std::shared_ptr<wrench::StorageService>> &grid_storage_services,
-    std::vector<std::shared_ptr<wrench::DataFile>> &files,
+    std::shared_ptr<const FileList> files,
     double total_flops, bool prefetch_on) : CacheComputation::CacheComputation(
         cache_storage_services,
         grid_storage_services,
@@ -38,9 +38,19 @@ StreamedComputation::StreamedComputation(
 void StreamedComputation::performComputation(std::shared_ptr<wrench::ActionExecutor> action_executor) {
 
     auto the_action = std::dynamic_pointer_cast<MonitorAction>(action_executor->getAction()); // executed action
+    auto& activities = the_action->get_activity_counters();
 
     double infile_transfer_time = 0.;
     double compute_time = 0.;
+    double io_stall_time = 0.;
+
+    // Optional recording of the block timeline
+    auto trace = SimpleSimulator::trace_recorder;
+    std::string hostname = trace ? action_executor->getHostname() : "";
+    std::string job_name = trace ? the_action->getJob()->getName() : "";
+
+    // Bookkeeping of the streamed blocks, the simulated reads and computations are excluded
+    Profiler::Scope profile(SimpleSimulator::profiler, "computation", "block streaming");
 
     WRENCH_INFO("Performing streamed computation!");
     // Incremental size of all input files to be processed
@@ -51,13 +61,23 @@ void StreamedComputation::performComputation(std::shared_ptr<wrench::ActionExecu
 
         // Compute the number of blocks
         int num_blocks = int(std::ceil(data_to_process / (double) SimpleSimulator::xrd_block_size));
+        // Every block is read and computed
+        SimpleSimulator::num_simulated_activities += 2 * num_blocks;
+        activities.reads += num_blocks;
+        activities.execs += num_blocks;
 
         // Read the first block
         double read_start_time = wrench::Simulation::getCurrentSimulatedDate();
-        fs.second->getStorageService()->readFile(fs.second, std::min<double>(SimpleSimulator::xrd_block_size, data_to_process));
+        profile.excluding([&]() { fs.second->getStorageService()->readFile(fs.second, std::min<double>(SimpleSimulator::xrd_block_size, data_to_process)); });
+        activities.messages += ActivityCounters::messagesPerTransfer(std::min<double>(SimpleSimulator::xrd_block_size, data_to_process), SimpleSimulator::storage_buffer_size);
         double read_end_time = wrench::Simulation::getCurrentSimulatedDate();
         if (read_end_time > read_start_time) {
             infile_transfer_time += read_end_time - read_start_time;
+            // Nothing to compute before the first block has arrived
+            io_stall_time += read_end_time - read_start_time;
+            if (trace) {
+                trace->record(TraceRecorder::EventType::BlockRead, hostname, job_name, read_start_time, read_end_time, std::min<double>(SimpleSimulator::xrd_block_size, data_to_process));
+            }
         } else {
             throw std::runtime_error(
                     "Reading block " + std::to_string(0) +
@@ -75,26 +95,35 @@ void StreamedComputation::performComputation(std::shared_ptr<wrench::ActionExecu
             double exec_start_time = 0.0;
             double exec_end_time = 0.0;
             if(this->prefetching_on){
-                exec->start();
+                profile.excluding([&]() { exec->start(); });
                 exec_start_time = exec->get_start_time();
                 // Read data from the file
                 read_start_time = wrench::Simulation::getCurrentSimulatedDate();
-                fs.second->getStorageService()->readFile(fs.second, num_bytes);
+                profile.excluding([&]() { fs.second->getStorageService()->readFile(fs.second, num_bytes); });
                 read_end_time = wrench::Simulation::getCurrentSimulatedDate();
                 // Wait for the computation to be done
-                exec->wait();
+                profile.excluding([&]() { exec->wait(); });
                 exec_end_time = exec->get_finish_time();
+                // The next block can only be computed once its read has finished
+                io_stall_time += std::max(0., read_end_time - exec_end_time);
             }
             else {
-                exec->start();
+                profile.excluding([&]() { exec->start(); });
                 exec_start_time = exec->get_start_time();
-                exec->wait();
+                profile.excluding([&]() { exec->wait(); });
                 exec_end_time = exec->get_finish_time();
                 read_start_time = wrench::Simulation::getCurrentSimulatedDate();
-                fs.second->getStorageService()->readFile(fs.second, num_bytes);
+                profile.excluding([&]() { fs.second->getStorageService()->readFile(fs.second, num_bytes); });
                 read_end_time = wrench::Simulation::getCurrentSimulatedDate();
+                // Without prefetching the computation is idle during the whole read
+                io_stall_time += read_end_time - read_start_time;
             }
             data_to_process -= num_bytes;
+            activities.messages += ActivityCounters::messagesPerTransfer(num_bytes, SimpleSimulator::storage_buffer_size);
+            if (trace) {
+                trace->record(TraceRecorder::EventType::BlockCompute, hostname, job_name, exec_start_time, exec_end_time, num_flops);
+                trace->record(TraceRecorder::EventType::BlockRead, hostname, job_name, read_start_time, read_end_time, num_bytes);
+            }
             if (exec_end_time >= exec_start_time) {
                 compute_time += exec_end_time - exec_start_time;
             } else {
@@ -116,10 +145,13 @@ void StreamedComputation::performComputation(std::shared_ptr<wrench::ActionExecu
         // Process last block
         double num_flops = determineFlops(std::min<double>(SimpleSimulator::xrd_block_size, data_to_process), total_data_size);
         simgrid::s4u::ExecPtr exec = simgrid::s4u::this_actor::exec_init(num_flops);
-        exec->start();
+        profile.excluding([&]() { exec->start(); });
         double exec_start_time = exec->get_start_time();
-        exec->wait();
+        profile.excluding([&]() { exec->wait(); });
         double exec_end_time = exec->get_finish_time();
+        if (trace) {
+            trace->record(TraceRecorder::EventType::BlockCompute, hostname, job_name, exec_start_time, exec_end_time, num_flops);
+        }
         if (exec_end_time > exec_start_time) {
             compute_time += exec_end_time - exec_start_time;
         } else {
@@ -133,6 +165,7 @@ void StreamedComputation::performComputation(std::shared_ptr<wrench::ActionExecu
     // Fill monitoring information
     the_action->set_infile_transfer_time(infile_transfer_time);
     the_action->set_calculation_time(compute_time);
+    the_action->set_io_stall_time(io_stall_time);
 
 }
 
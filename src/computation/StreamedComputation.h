@@ -14,7 +14,7 @@ public:
     StreamedComputation(
         std::set<std::shared_ptr<wrench::StorageService>> &cache_storage_services,
         std::set<std::shared_ptr<wrench::StorageService>> &grid_storage_services,
-        std::vector<std::shared_ptr<wrench::DataFile>> &files,
+        std::shared_ptr<const FileList> files,
         double total_flops,
         bool prefetch_on
     );
@@ -0,0 +1,99 @@
+
+
+#ifndef S_PHILOX_H
+#define S_PHILOX_H
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+
+/**
+ * @brief Counter-based Philox4x32-10 random number generator (Salmon et al., SC'11).
+ * The output is a pure function of (key, counter), so independent streams can be
+ * addressed directly, e.g. one per job, and drawn from in any order or thread.
+ * Satisfies the UniformRandomBitGenerator requirements.
+ */
+class Philox4x32 {
+public:
+    using result_type = uint32_t;
+
+    /**
+     * @brief Construct a stream
+     *
+     * @param key 64-bit key selecting the family of streams (e.g. seed and workload)
+     * @param stream 64-bit index of the stream within the family (e.g. job index)
+     */
+    Philox4x32(uint64_t key, uint64_t stream) {
+        this->key = {static_cast<uint32_t>(key), static_cast<uint32_t>(key >> 32)};
+        this->counter = {0, 0, static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32)};
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        if (this->position == 4) {
+            this->output = bijection(this->counter, this->key);
+            // Advance the 64-bit draw counter, the upper half holds the stream index
+            if (++this->counter[0] == 0) ++this->counter[1];
+            this->position = 0;
+        }
+        return this->output[this->position++];
+    }
+
+private:
+    std::array<uint32_t, 2> key;
+    std::array<uint32_t, 4> counter;
+    std::array<uint32_t, 4> output = {0, 0, 0, 0};
+    unsigned int position = 4;
+
+    static std::array<uint32_t, 4> bijection(std::array<uint32_t, 4> ctr, std::array<uint32_t, 2> k) {
+        const uint32_t M0 = 0xD2511F53, M1 = 0xCD9E8D57;
+        const uint32_t W0 = 0x9E3779B9, W1 = 0xBB67AE85;
+        for (int round = 0; round < 10; round++) {
+            uint64_t p0 = static_cast<uint64_t>(M0) * ctr[0];
+            uint64_t p1 = static_cast<uint64_t>(M1) * ctr[2];
+            ctr = {
+                static_cast<uint32_t>(p1 >> 32) ^ ctr[1] ^ k[0], static_cast<uint32_t>(p1),
+                static_cast<uint32_t>(p0 >> 32) ^ ctr[3] ^ k[1], static_cast<uint32_t>(p0)
+            };
+            k[0] += W0;
+            k[1] += W1;
+        }
+        return ctr;
+    }
+};
+
+/**
+ * @brief Platform independent 64-bit FNV-1a hash, e.g. to derive stable stream keys from names
+ *
+ * @param s String to hash
+ * @param basis Offset basis, can be used to chain hashes
+ * @return uint64_t
+ */
+inline uint64_t fnv1a_64(const std::string& s, uint64_t basis = 0xcbf29ce484222325ULL) {
+    uint64_t h = basis;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+/**
+ * @brief SplitMix64 finalizer to combine seeds into well-mixed keys
+ *
+ * @param x
+ * @return uint64_t
+ */
+inline uint64_t mix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+
+#endif //S_PHILOX_H
@@ -0,0 +1,342 @@
+
+
+#ifndef S_SAMPLERS_H
+#define S_SAMPLERS_H
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <algorithm>
+#include <string>
+
+
+/**
+ * @brief Draw a uniformly distributed value in [0, 1) from an arbitrary
+ * uniform random bit generator
+ *
+ * @param generator Uniform random bit generator
+ * @return double
+ */
+template <class URBG>
+inline double uniform01(URBG& generator) {
+    double u = std::generate_canonical<double, std::numeric_limits<double>::digits>(generator);
+    // generate_canonical may round up to 1 for some generators
+    return u < 1. ? u : std::nextafter(1., 0.);
+}
+
+/**
+ * @brief Inverse of the standard normal cumulative distribution function
+ * (rational approximation by P. J. Acklam refined by one Halley step)
+ *
+ * @param p Probability in (0, 1)
+ * @return double
+ */
+inline double inverse_normal_cdf(double p) {
+    static const double a[] = {-3.969683028665376e+01,  2.209460984245205e+02, -2.759285104469687e+02,
+                                1.383577518672690e+02, -3.066479806614716e+01,  2.506628277459239e+00};
+    static const double b[] = {-5.447609879822406e+01,  1.615858368580409e+02, -1.556989798598866e+02,
+                                6.680131188771972e+01, -1.328068155288572e+01};
+    static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                               -2.549732539343734e+00,  4.374664141464968e+00,  2.938163982698783e+00};
+    static const double d[] = { 7.784695709041462e-03,  3.224671290700398e-01,  2.445134137142996e+00,
+                                3.754408661907416e+00};
+    if (p <= 0.) return -std::numeric_limits<double>::infinity();
+    if (p >= 1.) return std::numeric_limits<double>::infinity();
+
+    const double p_low = 0.02425;
+    double x;
+    if (p < p_low) {
+        double q = std::sqrt(-2*std::log(p));
+        x = (((((c[0]*q+c[1])*q+c[2])*q+c[3])*q+c[4])*q+c[5]) / ((((d[0]*q+d[1])*q+d[2])*q+d[3])*q+1);
+    } else if (p <= 1 - p_low) {
+        double q = p - 0.5;
+        double r = q*q;
+        x = (((((a[0]*r+a[1])*r+a[2])*r+a[3])*r+a[4])*r+a[5])*q / (((((b[0]*r+b[1])*r+b[2])*r+b[3])*r+b[4])*r+1);
+    } else {
+        double q = std::sqrt(-2*std::log(1-p));
+        x = -(((((c[0]*q+c[1])*q+c[2])*q+c[3])*q+c[4])*q+c[5]) / ((((d[0]*q+d[1])*q+d[2])*q+d[3])*q+1);
+    }
+    // Refinement to full machine precision
+    double e = 0.5 * std::erfc(-x/std::sqrt(2.)) - p;
+    double u = e * std::sqrt(2*M_PI) * std::exp(x*x/2);
+    return x - u/(1 + x*u/2);
+}
+
+/**
+ * @brief Cumulative distribution function of the standard normal distribution
+ *
+ * @param x
+ * @return double
+ */
+inline double normal_cdf(double x) {
+    return 0.5 * std::erfc(-x/std::sqrt(2.));
+}
+
+
+/**
+ * @brief Walker/Vose alias table drawing an index of a discrete distribution in O(1)
+ * with a single uniform random number
+ */
+class AliasTable {
+public:
+    AliasTable() = default;
+
+    /**
+     * @brief Construct the alias table from (not necessarily normalized) weights
+     *
+     * @param weights Non-negative weights, at least one of them positive
+     *
+     * @throw std::runtime_error
+     */
+    explicit AliasTable(const std::vector<double>& weights) {
+        size_t n = weights.size();
+        double sum = 0.;
+        for (auto w : weights) {
+            if (w < 0. || !std::isfinite(w)) {
+                throw std::runtime_error("AliasTable(): Weights have to be finite and non-negative!");
+            }
+            sum += w;
+        }
+        if (n == 0 || sum <= 0.) {
+            throw std::runtime_error("AliasTable(): At least one weight has to be positive!");
+        }
+
+        this->prob.assign(n, 1.);
+        this->alias.resize(n);
+        std::vector<double> scaled(n);
+        std::vector<size_t> small, large;
+        small.reserve(n);
+        large.reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            this->alias[i] = i;
+            scaled[i] = weights[i] * n / sum;
+            if (scaled[i] < 1.) small.push_back(i);
+            else large.push_back(i);
+        }
+        while (!small.empty() && !large.empty()) {
+            size_t s = small.back(); small.pop_back();
+            size_t l = large.back();
+            this->prob[s] = scaled[s];
+            this->alias[s] = l;
+            scaled[l] = (scaled[l] + scaled[s]) - 1.;
+            if (scaled[l] < 1.) {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+        // Remaining entries are (up to rounding) exactly full
+        for (auto i : large) this->prob[i] = 1.;
+        for (auto i : small) this->prob[i] = 1.;
+    }
+
+    /**
+     * @brief Draw an index from the table
+     *
+     * @param generator Uniform random bit generator
+     * @return size_t
+     */
+    template <class URBG>
+    size_t operator()(URBG& generator) const {
+        double u = uniform01(generator) * this->prob.size();
+        size_t i = std::min<size_t>(static_cast<size_t>(u), this->prob.size() - 1);
+        return (u - i) < this->prob[i] ? i : this->alias[i];
+    }
+
+    size_t size() const {
+        return this->prob.size();
+    }
+
+private:
+    std::vector<double> prob;
+    std::vector<size_t> alias;
+};
+
+
+/**
+ * @brief Sampler for integer valued job characteristics (e.g. cores).
+ * Every supported distribution is tabulated once into an alias table
+ * over its support truncated to [lower, upper].
+ */
+class IntSampler {
+public:
+    IntSampler() = default;
+
+    /**
+     * @brief Degenerate distribution always returning the same value
+     */
+    static IntSampler constant(int value) {
+        IntSampler s;
+        s.offset = value;
+        s.table = AliasTable({1.});
+        return s;
+    }
+
+    /**
+     * @brief Distribution over the indices 0..n-1 of the weights, truncated to [lower, upper]
+     *
+     * @throw std::runtime_error
+     */
+    static IntSampler histogram(const std::vector<double>& weights, int lower, int upper = std::numeric_limits<int>::max()) {
+        int first = std::max(lower, 0);
+        int last = std::min<long>(upper, static_cast<long>(weights.size()) - 1);
+        if (first > last) {
+            throw std::runtime_error("IntSampler::histogram(): No bins left within the truncation range!");
+        }
+        IntSampler s;
+        s.offset = first;
+        s.table = AliasTable(std::vector<double>(weights.begin() + first, weights.begin() + last + 1));
+        return s;
+    }
+
+    /**
+     * @brief Poisson distribution truncated to [lower, upper],
+     * tabulated until the neglected tail mass is below double precision
+     *
+     * @throw std::runtime_error
+     */
+    static IntSampler poisson(double mu, int lower, int upper = std::numeric_limits<int>::max()) {
+        if (mu < 0.) {
+            throw std::runtime_error("IntSampler::poisson(): Negative mean " + std::to_string(mu));
+        }
+        int first = std::max(lower, 0);
+        int tail = static_cast<int>(std::ceil(mu + 20.*std::sqrt(mu) + 20.));
+        int last = std::min(upper, std::max(tail, first));
+        std::vector<double> weights;
+        weights.reserve(last - first + 1);
+        for (int k = first; k <= last; k++) {
+            // Evaluate the pmf in log-space to avoid overflow for large mu
+            double log_pmf = (mu > 0. ? k*std::log(mu) : (k == 0 ? 0. : -INFINITY)) - mu - std::lgamma(k + 1.);
+            weights.push_back(std::exp(log_pmf));
+        }
+        IntSampler s;
+        s.offset = first;
+        s.table = AliasTable(weights);
+        return s;
+    }
+
+    template <class URBG>
+    int operator()(URBG& generator) const {
+        return this->offset + static_cast<int>(this->table(generator));
+    }
+
+private:
+    int offset = 0;
+    AliasTable table;
+};
+
+
+/**
+ * @brief Sampler for real valued job characteristics (e.g. flops, file sizes).
+ * The distribution is truncated to [lower, upper] at construction time,
+ * so every draw consumes a fixed amount of random numbers without rejection loops.
+ */
+class RealSampler {
+public:
+    RealSampler() = default;
+
+    /**
+     * @brief Degenerate distribution always returning the same value
+     */
+    static RealSampler constant(double value) {
+        RealSampler s;
+        s.kind = Kind::Constant;
+        s.value = value;
+        return s;
+    }
+
+    /**
+     * @brief Gaussian distribution truncated to [lower, upper], drawn via inverse CDF
+     *
+     * @throw std::runtime_error
+     */
+    static RealSampler gaussian(double mean, double sigma, double lower, double upper = INFINITY) {
+        if (sigma <= 0.) {
+            // Degenerate distribution: keep the mean if it lies within the range
+            return constant(std::min(std::max(mean, lower), upper));
+        }
+        RealSampler s;
+        s.kind = Kind::Gaussian;
+        s.mean = mean;
+        s.sigma = sigma;
+        s.cdf_lower = normal_cdf((lower - mean)/sigma);
+        s.cdf_upper = normal_cdf((upper - mean)/sigma);
+        s.lower = lower;
+        s.upper = upper;
+        if (!(s.cdf_upper > s.cdf_lower)) {
+            throw std::runtime_error(
+                "RealSampler::gaussian(): Truncation range [" + std::to_string(lower) + ", " + std::to_string(upper) +
+                "] has no probability mass for mean " + std::to_string(mean) + " and sigma " + std::to_string(sigma)
+            );
+        }
+        return s;
+    }
+
+    /**
+     * @brief Piecewise constant distribution with the given bin edges and counts
+     * truncated to [lower, upper]. Bins are picked via an alias table.
+     *
+     * @throw std::runtime_error
+     */
+    static RealSampler histogram(const std::vector<double>& bins, const std::vector<double>& counts, double lower, double upper = INFINITY) {
+        if (bins.size() < 2 || counts.size() < bins.size() - 1) {
+            throw std::runtime_error("RealSampler::histogram(): Need n+1 bin edges for n counts!");
+        }
+        RealSampler s;
+        s.kind = Kind::Histogram;
+        std::vector<double> weights;
+        for (size_t i = 0; i + 1 < bins.size(); i++) {
+            double lo = std::max(bins[i], lower);
+            double hi = std::min(bins[i+1], upper);
+            double width = bins[i+1] - bins[i];
+            if (hi <= lo || width <= 0. || counts[i] <= 0.) continue;
+            s.bin_lower.push_back(lo);
+            s.bin_width.push_back(hi - lo);
+            weights.push_back(counts[i] * (hi - lo) / width);
+        }
+        if (weights.empty()) {
+            throw std::runtime_error("RealSampler::histogram(): No bins left within the truncation range!");
+        }
+        s.table = AliasTable(weights);
+        return s;
+    }
+
+    template <class URBG>
+    double operator()(URBG& generator) const {
+        switch (this->kind) {
+            case Kind::Gaussian: {
+                double p = this->cdf_lower + uniform01(generator) * (this->cdf_upper - this->cdf_lower);
+                p = std::min(std::max(p, std::numeric_limits<double>::min()), std::nextafter(1., 0.));
+                double x = this->mean + this->sigma * inverse_normal_cdf(p);
+                return std::min(std::max(x, this->lower), this->upper);
+            }
+            case Kind::Histogram: {
+                size_t i = this->table(generator);
+                return this->bin_lower[i] + uniform01(generator) * this->bin_width[i];
+            }
+            default:
+                return this->value;
+        }
+    }
+
+private:
+    enum class Kind {Constant, Gaussian, Histogram};
+    Kind kind = Kind::Constant;
+
+    double value = 0.;
+
+    double mean = 0.;
+    double sigma = 0.;
+    double lower = 0.;
+    double upper = INFINITY;
+    double cdf_lower = 0.;
+    double cdf_upper = 1.;
+
+    AliasTable table;
+    std::vector<double> bin_lower;
+    std::vector<double> bin_width;
+};
+
+
+#endif //S_SAMPLERS_H
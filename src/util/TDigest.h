@@ -0,0 +1,145 @@
+
+
+#ifndef S_TDIGEST_H
+#define S_TDIGEST_H
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+
+/**
+ * @brief Merging t-digest (Dunning & Ertl, 2019) to estimate quantiles of a stream of values
+ * in bounded memory. Centroids are kept small towards the tails (k1 scale function),
+ * so extreme quantiles are estimated more accurately than the median.
+ */
+class TDigest {
+public:
+    struct Centroid {
+        double mean;
+        double weight;
+    };
+
+    /**
+     * @brief Construct an empty digest
+     *
+     * @param compression Scale parameter delta, the number of centroids stays below about delta
+     */
+    explicit TDigest(double compression = 100.) : compression(compression) {
+        this->buffer.reserve(this->bufferLimit());
+    }
+
+    /**
+     * @brief Add a value to the digest
+     *
+     * @param value
+     * @param weight
+     */
+    void add(double value, double weight = 1.) {
+        if (std::isnan(value)) return;
+        this->buffer.push_back({value, weight});
+        this->min = std::min(this->min, value);
+        this->max = std::max(this->max, value);
+        if (this->buffer.size() >= this->bufferLimit()) {
+            this->compress();
+        }
+    }
+
+    /**
+     * @brief Merge all buffered values into the centroids
+     */
+    void compress() {
+        if (this->buffer.empty()) return;
+        this->buffer.insert(this->buffer.end(), this->centroids.begin(), this->centroids.end());
+        std::sort(this->buffer.begin(), this->buffer.end(), [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; });
+        double total = 0.;
+        for (const auto& c : this->buffer) total += c.weight;
+
+        this->centroids.clear();
+        this->centroids.push_back(this->buffer.front());
+        double weight_so_far = 0.;
+        double q_limit = this->kInverse(this->k(0.) + 1.) * total;
+        for (size_t i = 1; i < this->buffer.size(); i++) {
+            auto& current = this->centroids.back();
+            const auto& next = this->buffer[i];
+            if (weight_so_far + current.weight + next.weight <= q_limit) {
+                current.weight += next.weight;
+                current.mean += (next.mean - current.mean) * next.weight / current.weight;
+            } else {
+                weight_so_far += current.weight;
+                q_limit = this->kInverse(this->k(weight_so_far / total) + 1.) * total;
+                this->centroids.push_back(next);
+            }
+        }
+        this->total_weight = total;
+        this->buffer.clear();
+    }
+
+    /**
+     * @brief Estimate the value at quantile q
+     *
+     * @param q Quantile in [0, 1]
+     * @return double, NaN if no value was added
+     */
+    double quantile(double q) {
+        this->compress();
+        if (this->centroids.empty()) return std::numeric_limits<double>::quiet_NaN();
+        if (q <= 0.) return this->min;
+        if (q >= 1.) return this->max;
+        if (this->centroids.size() == 1) return this->centroids.front().mean;
+
+        // Each centroid is located at the middle of its cumulative weight range
+        double target = q * this->total_weight;
+        const auto& first = this->centroids.front();
+        if (target < first.weight / 2.) {
+            return this->min + (first.mean - this->min) * target / (first.weight / 2.);
+        }
+        double cumulative = first.weight / 2.;
+        for (size_t i = 1; i < this->centroids.size(); i++) {
+            const auto& left = this->centroids[i - 1];
+            const auto& right = this->centroids[i];
+            double step = (left.weight + right.weight) / 2.;
+            if (target < cumulative + step) {
+                return left.mean + (right.mean - left.mean) * (target - cumulative) / step;
+            }
+            cumulative += step;
+        }
+        const auto& last = this->centroids.back();
+        double rest = this->total_weight - cumulative;
+        return last.mean + (this->max - last.mean) * std::min(1., (target - cumulative) / rest);
+    }
+
+    double count() {
+        this->compress();
+        return this->total_weight;
+    }
+
+    const std::vector<Centroid>& getCentroids() {
+        this->compress();
+        return this->centroids;
+    }
+
+private:
+    size_t bufferLimit() const {
+        return static_cast<size_t>(5 * std::ceil(this->compression));
+    }
+
+    /** @brief k1 scale function */
+    double k(double q) const {
+        return this->compression / (2. * M_PI) * std::asin(2. * q - 1.);
+    }
+
+    double kInverse(double k) const {
+        return (std::sin(std::min(k * 2. * M_PI / this->compression, M_PI / 2.)) + 1.) / 2.;
+    }
+
+    double compression;
+    double total_weight = 0.;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    std::vector<Centroid> centroids;
+    std::vector<Centroid> buffer;
+};
+
+#endif //S_TDIGEST_H
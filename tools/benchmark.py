@@ -0,0 +1,79 @@
+#! /usr/bin/python3
+
+# Benchmark harness running a canonical set of simulation scenarios with fixed seeds
+# and collecting the simulator's performance reports (wall time per phase, peak RSS,
+# simulated activities and jobs per second) into a single JSON file.
+
+import argparse
+import json
+import os.path
+import subprocess
+import sys
+import tempfile
+
+
+this_dir = os.path.dirname(os.path.abspath(__file__))
+repo_dir = os.path.dirname(this_dir)
+
+# Job characteristics used by the simScaling scenarios
+WORKLOAD_OPTIONS = [
+    "--ninfiles", "10", "--insize", "3600000000", "--sigma-insize", "360000000",
+    "--flops", "2164428000000", "--sigma-flops", "216442800000", "--mem", "2000000000",
+    "--outsize", "18000000000", "--sigma-outsize", "1800000000",
+    "--duplications", "1", "--hitrate", "0.0", "--xrd-blocksize", "1000000000",
+]
+
+PLATFORMS = {
+    "sgbatch": "data/platform-files/sgbatch.xml",
+    "ETPbatch": "data/platform-files/ETPbatch.xml",
+    "WLCG_disklessTier2": "data/platform-files/WLCG_disklessTier2.xml",
+}
+
+
+def run_scenario(executable, platform, njobs, seed):
+    with tempfile.TemporaryDirectory() as tmpdir:
+        report_file = os.path.join(tmpdir, "report.json")
+        command = [
+            executable,
+            "--platform", os.path.join(repo_dir, PLATFORMS[platform]),
+            "--njobs", str(njobs),
+            *WORKLOAD_OPTIONS,
+            "--seed", str(seed),
+            "--output-file", os.devnull,
+            "--bench-report", report_file,
+        ]
+        print("Running scenario {} with {} jobs...".format(platform, njobs), file=sys.stderr)
+        result = subprocess.run(command, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        if result.returncode != 0 or not os.path.exists(report_file):
+            raise RuntimeError("Scenario {} with {} jobs failed (exit code {})".format(platform, njobs, result.returncode))
+        with open(report_file) as f:
+            report = json.load(f)
+    report["scenario"] = platform
+    report["njobs"] = njobs
+    report["seed"] = seed
+    return report
+
+
+parser = argparse.ArgumentParser(
+    description="Run the canonical benchmark scenarios of the simulator and report its performance as JSON"
+)
+parser.add_argument("--executable", type=str, default="dc-sim", help="simulator executable to benchmark")
+parser.add_argument("--scenarios", type=str, nargs="+", default=list(PLATFORMS.keys()), choices=list(PLATFORMS.keys()), help="platforms to simulate")
+parser.add_argument("--njobs", type=int, nargs="+", default=[100, 1000, 10000], help="job counts to simulate on every platform")
+parser.add_argument("--seed", type=int, default=42, help="seed of the simulations")
+parser.add_argument("--output", type=str, default="-", help="path of the JSON report, - for stdout")
+
+args = parser.parse_args()
+
+reports = []
+for platform in args.scenarios:
+    for njobs in args.njobs:
+        reports.append(run_scenario(args.executable, platform, njobs, args.seed))
+
+benchmark = {"executable": args.executable, "scenarios": reports}
+if args.output == "-":
+    json.dump(benchmark, sys.stdout, indent=4)
+    print()
+else:
+    with open(args.output, "w") as f:
+        json.dump(benchmark, f, indent=4)
@@ -0,0 +1,137 @@
+#! /usr/bin/python3
+
+# Calibration of the cost model used by the --dry-run estimate of the simulator:
+# runs a set of scenarios varying job count, workload type and storage buffer size,
+# and additionally input files per job, hitrate and duplications, so that the counts
+# of jobs, files and file locations are not proportional to each other.
+# Takes the counts from the dry run and the measured wall time and peak RSS from the
+# benchmark report, and fits the linear coefficients by least squares.
+
+import argparse
+import itertools
+import json
+import os.path
+import subprocess
+import sys
+import tempfile
+
+import numpy as np
+
+
+this_dir = os.path.dirname(os.path.abspath(__file__))
+repo_dir = os.path.dirname(this_dir)
+
+WORKLOAD_OPTIONS = [
+    "--insize", "3600000000", "--sigma-insize", "360000000",
+    "--flops", "2164428000000", "--sigma-flops", "216442800000", "--mem", "2000000000",
+    "--outsize", "18000000000", "--sigma-outsize", "1800000000",
+    "--xrd-blocksize", "1000000000",
+]
+
+# counts of the dry run and the coefficients of the cost model scaling them
+WALLTIME_TERMS = {"jobs": "walltime_per_job", "activities": "walltime_per_activity", "messages": "walltime_per_message"}
+MEMORY_TERMS = {"jobs": "memory_per_job", "files": "memory_per_file", "file_locations": "memory_per_file_location"}
+
+
+def run(executable, platform, njobs, workload_type, buffer_size, ninfiles, hitrate, duplications, seed):
+    options = [
+        executable,
+        "--platform", os.path.join(repo_dir, platform),
+        "--njobs", str(njobs),
+        "--ninfiles", str(ninfiles),
+        "--hitrate", str(hitrate),
+        "--duplications", str(duplications),
+        *WORKLOAD_OPTIONS,
+        "--workload-type", workload_type,
+        "--storage-buffer-size", buffer_size,
+        "--seed", str(seed),
+    ]
+    dry_run = subprocess.run(options + ["--dry-run"], stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, universal_newlines=True, check=True)
+    estimate = json.loads(dry_run.stdout)["estimate"]
+    with tempfile.TemporaryDirectory() as tmpdir:
+        report_file = os.path.join(tmpdir, "report.json")
+        subprocess.run(options + ["--output-file", os.devnull, "--bench-report", report_file], stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, check=True)
+        with open(report_file) as f:
+            report = json.load(f)
+    estimate["walltime"] = report["walltime"]
+    estimate["peak_memory"] = report["peak_rss"]
+    return estimate
+
+
+def calibration_grid(args):
+    """Full grid of job count, workload type and buffer size at the first input files per job,
+    hitrate and duplications, plus each further value of these three at all job counts"""
+    base = (args.ninfiles[0], args.hitrates[0], args.duplications[0])
+    grid = [(njobs, workload_type, buffer_size) + base
+            for njobs, workload_type, buffer_size in itertools.product(args.njobs, args.workload_types, args.buffer_sizes)]
+    for factor, values in enumerate([args.ninfiles, args.hitrates, args.duplications]):
+        for value in values[1:]:
+            variation = list(base)
+            variation[factor] = value
+            grid += [(njobs, args.workload_types[0], args.buffer_sizes[0]) + tuple(variation) for njobs in args.njobs]
+    return grid
+
+
+def fit(samples, target, terms):
+    """Least squares fit of target = base + sum(coefficient * term), negative coefficients are clipped.
+    Fails when the grid can not separate the terms, and reports the condition number and residual."""
+    matrix = np.array([[1.] + [float(sample[term]) for term in terms] for sample in samples])
+    values = np.array([float(sample[target]) for sample in samples])
+    # Columns scaled to unit norm, so the condition number reflects the collinearity of the terms, not their units
+    norms = np.linalg.norm(matrix, axis=0)
+    norms[norms == 0.] = 1.
+    scaled = matrix / norms
+    rank = np.linalg.matrix_rank(scaled)
+    if rank < matrix.shape[1]:
+        raise RuntimeError("The terms {} of {} can not be separated by the calibration grid (rank {} of {}), vary more options".format(
+            ", ".join(terms), target, rank, matrix.shape[1]))
+    coefficients = np.linalg.lstsq(scaled, values, rcond=None)[0] / norms
+    clipped = [max(0., c) for c in coefficients]
+    residual = values - matrix.dot(clipped)
+    relative_rms = np.sqrt(np.mean((residual / values) ** 2))
+    print("Fit of {}: condition number {:.3g}, relative RMS residual {:.3g}".format(target, np.linalg.cond(scaled), relative_rms), file=sys.stderr)
+    for name, c in zip(["base"] + list(terms), coefficients):
+        if c < 0.:
+            print("\tWarning: negative coefficient {:.3g} of {} clipped to 0".format(c, name), file=sys.stderr)
+    return clipped
+
+
+parser = argparse.ArgumentParser(
+    description="Calibrate the cost model of the simulator's dry run against measured runs"
+)
+parser.add_argument("--executable", type=str, default="dc-sim", help="simulator executable to calibrate")
+parser.add_argument("--platform", type=str, default="data/platform-files/sgbatch.xml", help="platform to simulate, relative to the repository")
+parser.add_argument("--njobs", type=int, nargs="+", default=[100, 1000, 5000], help="job counts to simulate")
+parser.add_argument("--workload-types", type=str, nargs="+", default=["streaming", "copy"], help="workload types to simulate")
+parser.add_argument("--buffer-sizes", type=str, nargs="+", default=["infinity", "100000000"], help="storage buffer sizes to simulate")
+parser.add_argument("--ninfiles", type=int, nargs="+", default=[10, 30], help="input files per job to simulate")
+parser.add_argument("--hitrates", type=float, nargs="+", default=[0.5, 0.], help="initial hitrates to simulate")
+parser.add_argument("--duplications", type=int, nargs="+", default=[1, 3], help="duplications of the workload to simulate")
+parser.add_argument("--seed", type=int, default=42, help="seed of the simulations")
+parser.add_argument("--output", type=str, default="-", help="path of the cost model JSON file, - for stdout")
+
+args = parser.parse_args()
+
+samples = []
+for njobs, workload_type, buffer_size, ninfiles, hitrate, duplications in calibration_grid(args):
+    print("Running {} {} jobs with {} input files, hitrate {}, {} duplications and buffer size {}...".format(
+        njobs, workload_type, ninfiles, hitrate, duplications, buffer_size), file=sys.stderr)
+    samples.append(run(args.executable, args.platform, njobs, workload_type, buffer_size, ninfiles, hitrate, duplications, args.seed))
+if len(samples) <= max(len(WALLTIME_TERMS), len(MEMORY_TERMS)):
+    raise RuntimeError("At least {} scenarios are needed for the fit".format(max(len(WALLTIME_TERMS), len(MEMORY_TERMS)) + 1))
+
+walltime = fit(samples, "walltime", WALLTIME_TERMS)
+memory = fit(samples, "peak_memory", MEMORY_TERMS)
+model = {"base_walltime": walltime[0], "base_memory": memory[0]}
+for term, coefficient in zip(WALLTIME_TERMS, walltime[1:]):
+    model[WALLTIME_TERMS[term]] = coefficient
+for term, coefficient in zip(MEMORY_TERMS, memory[1:]):
+    model[MEMORY_TERMS[term]] = coefficient
+
+if args.output == "-":
+    json.dump(model, sys.stdout, indent=4)
+    print()
+else:
+    with open(args.output, "w") as f:
+        json.dump(model, f, indent=4)
+        f.write("\n")
@@ -0,0 +1,237 @@
+#! /usr/bin/python3
+
+# Seed ensemble runner (installed as dc-sim-ensemble): runs every configuration of a sweep
+# specification (see sweep.py) with several seeds in parallel worker processes, aggregates
+# per-run metrics (makespan, mean job wall time, byte hitrate, throughput) and reports their
+# means with Student-t confidence intervals. Seeds are added to a configuration until the
+# relative width of all confidence intervals is below the requested one, or the maximum
+# number of seeds is reached. The missing seeds are estimated from the current interval
+# widths and started in parallel.
+
+import argparse
+import csv
+import json
+import math
+import os
+import os.path
+import shutil
+import statistics
+import sys
+
+try:
+    import sweep
+except ImportError:
+    # installed as dc-sim-ensemble next to dc-sim-sweep
+    import importlib.machinery
+    import importlib.util
+    loader = importlib.machinery.SourceFileLoader("sweep", os.path.join(os.path.dirname(os.path.abspath(__file__)), "dc-sim-sweep"))
+    sweep = importlib.util.module_from_spec(importlib.util.spec_from_loader("sweep", loader))
+    loader.exec_module(sweep)
+
+
+METRICS = ["makespan", "walltime", "bytehitrate", "throughput"]
+
+
+def t_quantile(p, dof):
+    """Quantile of Student's t-distribution, exact for 1 and 2 degrees of freedom,
+    Cornish-Fisher expansion around the normal quantile otherwise"""
+    if dof == 1:
+        return math.tan(math.pi * (p - 0.5))
+    if dof == 2:
+        return (2. * p - 1.) / math.sqrt(2. * p * (1. - p))
+    z = statistics.NormalDist().inv_cdf(p)
+    return (z + (z**3 + z) / (4. * dof)
+            + (5. * z**5 + 16. * z**3 + 3. * z) / (96. * dof**2)
+            + (3. * z**7 + 19. * z**5 + 17. * z**3 - 15. * z) / (384. * dof**3)
+            + (79. * z**9 + 776. * z**7 + 1482. * z**5 - 1920. * z**3 - 945. * z) / (92160. * dof**4))
+
+
+def confidence_interval(values, confidence):
+    """Mean and half-width of the confidence interval of the mean"""
+    if not values:
+        return math.nan, math.inf
+    mean = statistics.mean(values)
+    if len(values) < 2:
+        return mean, math.inf
+    error = statistics.stdev(values) / math.sqrt(len(values))
+    return mean, t_quantile(0.5 + confidence / 2., len(values) - 1) * error
+
+
+def run_metrics(output_file):
+    """Metrics of a single simulation from its job output"""
+    jobs = 0
+    end = 0.
+    walltime = 0.
+    infile_size = 0.
+    cached_size = 0.
+    with open(output_file) as f:
+        for job in csv.DictReader(f, skipinitialspace=True):
+            jobs += 1
+            end = max(end, float(job["job.end"]))
+            walltime += float(job["job.end"]) - float(job["job.start"])
+            infile_size += float(job["infiles.size"])
+            cached_size += float(job["infiles.cachedsize"])
+    return {
+        "makespan": end,
+        "walltime": walltime / jobs if jobs else 0.,
+        "bytehitrate": cached_size / infile_size if infile_size > 0. else 0.,
+        "throughput": jobs / end if end > 0. else 0.,
+    }
+
+
+class Configuration:
+    """Ensemble of runs of a configuration with different seeds"""
+
+    def __init__(self, index, point):
+        self.index = index
+        self.point = point
+        self.started = 0
+        self.running = 0
+        self.failed = 0
+        self.metrics = []
+
+    def summary(self, confidence):
+        return {metric: confidence_interval([m[metric] for m in self.metrics], confidence) for metric in METRICS}
+
+    def converged(self, confidence, width, stop_metrics):
+        """Relative width of the confidence intervals of all stop metrics is below the requested one"""
+        summary = self.summary(confidence)
+        for metric in stop_metrics:
+            mean, half_width = summary[metric]
+            if mean == 0.:
+                if half_width > 0.:
+                    return False
+            elif 2. * half_width / abs(mean) > width:
+                return False
+        return True
+
+    def seeds_needed(self, confidence, width, stop_metrics, max_seeds):
+        """Estimate of the number of seeds, at which the relative width of the confidence intervals
+        of all stop metrics reaches the requested one, assuming the width shrinks with the square root
+        of the number of runs, capped at the maximal number of seeds"""
+        runs = len(self.metrics)
+        summary = self.summary(confidence)
+        needed = runs
+        for metric in stop_metrics:
+            mean, half_width = summary[metric]
+            if mean == 0.:
+                ratio = math.inf if half_width > 0. else 0.
+            else:
+                ratio = 2. * half_width / abs(mean) / width
+            if ratio > 1.:
+                needed = max(needed, runs + 1, min(max_seeds, runs * ratio**2))
+        return min(max_seeds, math.ceil(needed))
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Run seed ensembles of the configurations of a sweep specification and report means with confidence intervals"
+    )
+    parser.add_argument("specification", type=str, help="JSON file specifying the base options and the swept parameters (without seed)")
+    parser.add_argument("--executable", type=str, default=None, help="simulator executable, overrides the specification")
+    parser.add_argument("--workers", "-j", type=int, default=os.cpu_count(), help="number of simulations run in parallel")
+    parser.add_argument("--min-seeds", type=int, default=5, help="number of seeds run at least per configuration")
+    parser.add_argument("--max-seeds", type=int, default=50, help="number of seeds run at most per configuration")
+    parser.add_argument("--first-seed", type=int, default=1, help="seed of the first run, the following runs increment it")
+    parser.add_argument("--confidence", type=float, default=0.95, help="confidence level of the intervals")
+    parser.add_argument("--ci-width", type=float, default=0.02, help="relative width of the confidence intervals (width / mean) to stop adding seeds")
+    parser.add_argument("--stop-metrics", type=str, nargs="+", default=METRICS, choices=METRICS, help="metrics whose intervals have to reach the requested width")
+    parser.add_argument("--workdir", type=str, default="ensemble", help="directory for the outputs and logs of the single runs")
+    parser.add_argument("--output", type=str, default="ensemble.csv", help="path of the result table, - for stdout")
+    parser.add_argument("--runs-output", type=str, default=None, help="path for a table of the metrics of every run")
+    args = parser.parse_args()
+
+    if args.min_seeds < 2 or args.max_seeds < args.min_seeds:
+        raise ValueError("At least 2 seeds are needed, and the maximal number of seeds can't be below the minimal")
+    with open(args.specification) as f:
+        spec = json.load(f)
+    if "seed" in spec.get("sweep", {}):
+        raise ValueError("The seed is chosen by the ensemble and must not be swept")
+    spec_dir = os.path.dirname(os.path.abspath(args.specification))
+    executable = args.executable or spec.get("executable", "dc-sim")
+    workdir = os.path.abspath(args.workdir)
+    num_workers = max(1, args.workers)
+
+    configurations = [Configuration(index, point) for index, point in enumerate(sweep.sweep_points(spec))]
+    runs_table = []
+    running = []
+    num_runs = 0
+
+    def wants_seed(configuration):
+        if configuration.started >= args.max_seeds:
+            return False
+        if configuration.started < args.min_seeds:
+            return True
+        if len(configuration.metrics) < 2:
+            # Without an interval to extrapolate from, replace failed runs once all started runs are accounted
+            return configuration.running == 0
+        # Start all seeds estimated to be missing at once, the estimate is refined as their runs finish
+        return configuration.started < configuration.seeds_needed(args.confidence, args.ci_width, args.stop_metrics, args.max_seeds)
+
+    print("Running seed ensembles of {} configurations with {} workers...".format(len(configurations), num_workers), file=sys.stderr)
+    while True:
+        # Fill the free workers, round-robin over the configurations
+        started = True
+        while len(running) < num_workers and started:
+            started = False
+            for configuration in configurations:
+                if len(running) >= num_workers:
+                    break
+                if not wants_seed(configuration):
+                    continue
+                seed = args.first_seed + configuration.started
+                run = sweep.prepare_run(num_runs, dict(configuration.point, seed=seed), spec, spec_dir, workdir)
+                run.configuration = configuration
+                sweep.start_run(run, executable, spec_dir)
+                running.append(run)
+                configuration.started += 1
+                configuration.running += 1
+                num_runs += 1
+                started = True
+        if not running:
+            break
+        for run in sweep.finished_runs(running):
+            configuration = run.configuration
+            configuration.running -= 1
+            if run.returncode != 0:
+                configuration.failed += 1
+                print("Run {} {}: FAILED (exit code {}, see {})".format(run.index, json.dumps(run.point), run.returncode, run.log_file), file=sys.stderr)
+                continue
+            metrics = run_metrics(run.output_file)
+            configuration.metrics.append(metrics)
+            runs_table.append([str(configuration.index)] + [json.dumps(v).strip('"') for v in run.point.values()] + ["{:.6g}".format(metrics[m]) for m in METRICS])
+            shutil.rmtree(run.directory)
+            if configuration.running == 0 and configuration.started >= args.min_seeds:
+                status = "converged" if configuration.converged(args.confidence, args.ci_width, args.stop_metrics) else "not converged"
+                print("Configuration {} {}: {} runs, {}".format(configuration.index, json.dumps(configuration.point), len(configuration.metrics), status), file=sys.stderr)
+
+    coordinates = list(configurations[0].point.keys()) if configurations else []
+    with (sys.stdout if args.output == "-" else open(args.output, "w")) as out:
+        columns = ["config"] + ["sweep." + c for c in coordinates] + ["runs", "converged"]
+        for metric in METRICS:
+            columns += [metric + ".mean", metric + ".cilow", metric + ".cihigh"]
+        out.write(", ".join(columns) + "\n")
+        for configuration in configurations:
+            if not configuration.metrics:
+                continue
+            row = [str(configuration.index)] + [json.dumps(configuration.point[c]).strip('"') for c in coordinates]
+            row += [str(len(configuration.metrics)), str(configuration.converged(args.confidence, args.ci_width, args.stop_metrics)).lower()]
+            for metric, (mean, half_width) in configuration.summary(args.confidence).items():
+                row += ["{:.6g}".format(mean), "{:.6g}".format(mean - half_width), "{:.6g}".format(mean + half_width)]
+            out.write(", ".join(row) + "\n")
+    if args.runs_output:
+        with open(args.runs_output, "w") as out:
+            out.write(", ".join(["config"] + ["sweep." + c for c in coordinates] + ["seed"] + METRICS) + "\n")
+            for row in runs_table:
+                out.write(", ".join(row) + "\n")
+
+    failed = sum(configuration.failed for configuration in configurations)
+    if failed:
+        print("{} runs failed, their logs are kept in {}".format(failed, workdir), file=sys.stderr)
+        sys.exit(1)
+    if os.path.isdir(workdir) and not os.listdir(workdir):
+        os.rmdir(workdir)
+
+
+if __name__ == "__main__":
+    main()
@@ -41,6 +41,10 @@ action() {
         mkdir -p $OUTDIR
     fi
 
+    # Generate the workload only once and reuse it for all scan points
+    local SNAPSHOT="$OUTDIR/workload_snapshot_${SCENARIO}.bin"
+    local WORKLOAD_SNAPSHOT_OPTION="--save-workload $SNAPSHOT"
+
     for hitrate in $(LANG=en_UK seq 0.0 0.1 1.0)
     do 
         dc-sim --platform "$PLATFORM" \
@@ -51,11 +55,13 @@ action() {
             --cfg=network/loopback-bw:100000000000000 \
             --storage-buffer-size $STORAGE_BUFFER_SIZE \
             --no-caching \
+            $WORKLOAD_SNAPSHOT_OPTION \
             --workload-configurations "$WORKLOAD" #\
             # --no-streaming \
             # --wrench-full-log
             # --log=simple_wms.threshold=debug \
             # --log=cache_computation.threshold=debug
+        WORKLOAD_SNAPSHOT_OPTION="--load-workload $SNAPSHOT"
     done
 }
 
@@ -31,6 +31,10 @@ action() {
         mkdir -p $OUTDIR
     fi
 
+    # Generate the workload only once and reuse it for all scan points
+    local SNAPSHOT="$OUTDIR/workload_snapshot_${SCENARIO}.bin"
+    local WORKLOAD_SNAPSHOT_OPTION="--save-workload $SNAPSHOT"
+
     for prefetchrate in $(LANG=en_US seq 0.0 0.1 1.0)
     do 
         dc-sim --platform "$PLATFORM" \
@@ -41,11 +45,13 @@ action() {
             --storage-buffer-size $STORAGE_BUFFER_SIZE \
             --cache-scope network \
             --no-caching \
+            $WORKLOAD_SNAPSHOT_OPTION \
             --workload-configurations $WORKLOADS #\
             # --no-streaming \
             # --wrench-full-log
             # --log=simple_wms.threshold=debug \
             # --log=cache_computation.threshold=debug
+        WORKLOAD_SNAPSHOT_OPTION="--load-workload $SNAPSHOT"
     done
 }
 
@@ -0,0 +1,125 @@
+#! /usr/bin/python3
+
+# Regression gate running small fixed-seed simulation scenarios and comparing their
+# results (job count, mean hitrate, makespan) and the simulator's performance
+# (wall time, peak RSS, simulated activities) against a checked-in baseline with tolerances.
+# Every scenario is run twice, and its seeded results have to be reproduced exactly.
+# Exit codes: 0 passed, 1 failed, 77 skipped because no baseline is recorded for the scenario.
+
+import argparse
+import csv
+import json
+import os.path
+import subprocess
+import sys
+import tempfile
+
+
+this_dir = os.path.dirname(os.path.abspath(__file__))
+repo_dir = os.path.dirname(this_dir)
+
+SKIP_RETURN_CODE = 77
+
+# Metrics fixed by the seed, which are identical on every machine
+SEEDED_METRICS = ["jobs", "mean_hitrate", "makespan", "activities"]
+
+
+def run_scenario(executable, scenario):
+    with tempfile.TemporaryDirectory() as tmpdir:
+        output_file = os.path.join(tmpdir, "jobs.csv")
+        report_file = os.path.join(tmpdir, "report.json")
+        command = [
+            executable,
+            "--platform", os.path.join(repo_dir, scenario["platform"]),
+            *scenario["options"],
+            "--output-file", output_file,
+            "--bench-report", report_file,
+        ]
+        result = subprocess.run(command, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, universal_newlines=True)
+        if result.returncode != 0 or not os.path.exists(report_file):
+            sys.stderr.write(result.stderr[-4096:])
+            raise RuntimeError("Simulation failed (exit code {})".format(result.returncode))
+        with open(report_file) as f:
+            report = json.load(f)
+        with open(output_file) as f:
+            jobs = list(csv.DictReader(f, skipinitialspace=True))
+
+    hitrates = [float(job["hitrate"]) for job in jobs]
+    return {
+        "jobs": len(jobs),
+        "mean_hitrate": sum(hitrates) / len(hitrates) if hitrates else 0.,
+        "makespan": max((float(job["job.end"]) for job in jobs), default=0.),
+        "walltime": report["walltime"],
+        "peak_rss": report["peak_rss"],
+        "activities": report["activities"],
+    }
+
+
+def compare(measured, expected, tolerances):
+    """Return a list of violations, metrics without tolerance or expected value are not checked"""
+    violations = []
+    for metric, tolerance in tolerances.items():
+        if metric not in expected:
+            print("{}: no expected value recorded, measured {:.6g}".format(metric, measured[metric]), file=sys.stderr)
+            continue
+        allowed = tolerance.get("absolute", 0.) + tolerance.get("relative", 0.) * abs(expected[metric])
+        deviation = measured[metric] - expected[metric]
+        # Performance metrics may only get worse within the tolerance, improvements always pass
+        if tolerance.get("upper_only", False):
+            deviation = max(0., deviation)
+        if abs(deviation) > allowed:
+            violations.append("{}: measured {:.6g}, expected {:.6g} (allowed deviation {:.6g})".format(
+                metric, measured[metric], expected[metric], allowed))
+    return violations
+
+
+parser = argparse.ArgumentParser(
+    description="Compare the results and performance of a simulation scenario against the regression baseline"
+)
+parser.add_argument("--executable", type=str, default="dc-sim", help="simulator executable to test")
+parser.add_argument("--baseline", type=str, default=os.path.join(this_dir, "regression_baseline.json"), help="path of the baseline JSON file")
+parser.add_argument("--scenario", type=str, nargs="+", help="scenarios to run, default all in the baseline")
+parser.add_argument("--update", action="store_true", help="record the measured values as new baseline instead of comparing")
+
+args = parser.parse_args()
+
+with open(args.baseline) as f:
+    baseline = json.load(f)
+scenario_names = args.scenario if args.scenario else list(baseline["scenarios"].keys())
+
+failed = False
+skipped = False
+for name in scenario_names:
+    if name not in baseline["scenarios"]:
+        raise RuntimeError("Scenario {} is not defined in the baseline {}".format(name, args.baseline))
+    scenario = baseline["scenarios"][name]
+    print("Running scenario {}...".format(name), file=sys.stderr)
+    measured = run_scenario(args.executable, scenario)
+    print(json.dumps(measured, indent=4), file=sys.stderr)
+    repeated = run_scenario(args.executable, scenario)
+    violations = ["{}: not reproduced with the same seed, measured {:.6g} and {:.6g}".format(metric, measured[metric], repeated[metric])
+                  for metric in SEEDED_METRICS if repeated[metric] != measured[metric]]
+
+    if args.update:
+        if violations:
+            raise RuntimeError("Scenario {} is not reproducible, not recording it: {}".format(name, "; ".join(violations)))
+        scenario["expected"] = measured
+        continue
+    if scenario.get("expected"):
+        violations += compare(measured, scenario["expected"], baseline["tolerances"])
+    else:
+        print("No baseline recorded for scenario {}, record one with --update".format(name), file=sys.stderr)
+        skipped = True
+    for violation in violations:
+        print("Scenario {} regressed: {}".format(name, violation), file=sys.stderr)
+    failed |= bool(violations)
+
+if args.update:
+    with open(args.baseline, "w") as f:
+        json.dump(baseline, f, indent=4)
+        f.write("\n")
+    print("Updated baseline {}".format(args.baseline), file=sys.stderr)
+elif failed:
+    sys.exit(1)
+elif skipped:
+    sys.exit(SKIP_RETURN_CODE)
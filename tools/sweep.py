@@ -0,0 +1,262 @@
+#! /usr/bin/python3
+
+# Parameter sweep runner (installed as dc-sim-sweep): runs one simulation per point of the
+# cartesian product of the swept parameters in a pool of parallel worker processes and merges
+# the job outputs, prefixed with the sweep coordinates, into a single result table.
+#
+# The sweep specification is a JSON file:
+# {
+#     "executable": "dc-sim",
+#     "base": {"platform": "data/platform-files/sgbatch.xml", "no-caching": true, "cfg": ["network/loopback-bw:100000000000000"]},
+#     "sweep": {"hitrate": {"start": 0.0, "stop": 1.0, "step": 0.1}, "seed": [1, 2, 3], "cache-size": ["1TB", "2.5TB"]},
+#     "reuse-workload": true
+# }
+# Options are given by their command-line name, switches as true/false. Relative paths are
+# taken relative to the specification. "cache-size" sets the size of the disks on all cache hosts
+# of the platform. With "reuse-workload" the workload is sampled once per combination of the
+# parameters it depends on and loaded from a snapshot by all other points.
+
+import argparse
+import csv
+import itertools
+import json
+import os
+import os.path
+import shutil
+import subprocess
+import sys
+import time
+import xml.etree.ElementTree as ET
+
+
+# Options passed in SimGrid's --name=value syntax
+SIMGRID_OPTIONS = {"cfg", "log"}
+# Options the sampled workload depends on, any other option can share a workload snapshot
+WORKLOAD_OPTIONS = {
+    "seed", "njobs", "ninfiles", "ncores", "flops", "sigma-flops", "mem", "sigma-mem",
+    "insize", "sigma-insize", "outsize", "sigma-outsize", "workload-type", "submission-time",
+    "workload-configurations", "load-workload",
+}
+PATH_OPTIONS = {"platform", "workload-configurations", "load-workload", "cost-model"}
+
+
+def expand_values(values):
+    """List of the values of a swept parameter, given as list or as range {start, stop, step}"""
+    if isinstance(values, dict):
+        start, stop, step = values["start"], values["stop"], values["step"]
+        if step <= 0:
+            raise ValueError("The step of a range has to be positive")
+        count = int(round((stop - start) / step)) + 1
+        return [round(start + i * step, 12) for i in range(count)]
+    if isinstance(values, list):
+        return values
+    return [values]
+
+
+def sweep_points(spec):
+    """Cartesian product of the swept parameters as list of dictionaries"""
+    names = list(spec.get("sweep", {}).keys())
+    values = [expand_values(spec["sweep"][name]) for name in names]
+    return [dict(zip(names, combination)) for combination in itertools.product(*values)]
+
+
+def resolve_path(value, spec_dir):
+    if isinstance(value, list):
+        return [resolve_path(v, spec_dir) for v in value]
+    return value if os.path.isabs(value) else os.path.join(spec_dir, value)
+
+
+def command_line(executable, options, spec_dir):
+    """Command line of the simulator for the given options"""
+    command = [executable]
+    for name, value in options.items():
+        if name in PATH_OPTIONS:
+            value = resolve_path(value, spec_dir)
+        if name in SIMGRID_OPTIONS:
+            for v in (value if isinstance(value, list) else [value]):
+                command.append("--{}={}".format(name, v))
+        elif isinstance(value, bool):
+            if value:
+                command.append("--" + name)
+        elif isinstance(value, list):
+            command += ["--" + name] + [str(v) for v in value]
+        else:
+            command += ["--" + name, str(value)]
+    return command
+
+
+def write_platform(platform, cache_size, path):
+    """Copy of the platform with the given size of the disks on all cache hosts"""
+    with open(platform) as f:
+        content = f.read()
+    # ElementTree drops the prolog, which SimGrid requires
+    prolog = content[:content.index("<platform")]
+    root = ET.fromstring(content)
+    for host in root.iter("host"):
+        types = [prop.get("value", "") for prop in host.findall("prop") if prop.get("id") == "type"]
+        if not any("cache" in t for t in types):
+            continue
+        for disk in host.iter("disk"):
+            for prop in disk.findall("prop"):
+                if prop.get("id") == "size":
+                    prop.set("value", str(cache_size))
+    with open(path, "w") as f:
+        f.write(prolog)
+        f.write(ET.tostring(root, encoding="unicode"))
+        f.write("\n")
+
+
+class Run:
+    """Simulation of a single sweep point"""
+
+    def __init__(self, index, point, options, directory):
+        self.index = index
+        self.point = point
+        self.options = options
+        self.directory = directory
+        self.output_file = os.path.join(directory, "jobs.csv")
+        self.log_file = os.path.join(directory, "log.txt")
+        self.process = None
+        self.returncode = None
+
+
+def prepare_run(index, point, spec, spec_dir, workdir):
+    """Run of the simulator with the base options of the specification and the options of the point"""
+    directory = os.path.join(workdir, "point_{}".format(index))
+    os.makedirs(directory, exist_ok=True)
+    options = dict(spec.get("base", {}))
+    for name, value in point.items():
+        if name == "cache-size":
+            platform = resolve_path(options["platform"], spec_dir)
+            options["platform"] = os.path.join(directory, "platform.xml")
+            write_platform(platform, value, options["platform"])
+        else:
+            options[name] = value
+    options["output-file"] = os.path.join(directory, "jobs.csv")
+    return Run(index, point, options, directory)
+
+
+def prepare_runs(spec, spec_dir, workdir):
+    return [prepare_run(index, point, spec, spec_dir, workdir) for index, point in enumerate(sweep_points(spec))]
+
+
+def start_run(run, executable, spec_dir):
+    command = command_line(executable, run.options, spec_dir)
+    with open(os.path.join(run.directory, "command.txt"), "w") as f:
+        f.write(" ".join(command) + "\n")
+    with open(run.log_file, "w") as log:
+        run.process = subprocess.Popen(command, stdout=log, stderr=subprocess.STDOUT, cwd=run.directory)
+
+
+def finished_runs(running):
+    """Wait until some of the running runs have finished, remove and return them"""
+    while True:
+        finished = [run for run in running if run.process.poll() is not None]
+        if finished:
+            for run in finished:
+                running.remove(run)
+                run.returncode = run.process.returncode
+            return finished
+        time.sleep(0.1)
+
+
+def workload_key(run):
+    return json.dumps({name: value for name, value in run.options.items() if name in WORKLOAD_OPTIONS}, sort_keys=True)
+
+
+def execute(runs, executable, spec_dir, workdir, num_workers, reuse_workload):
+    """Run the simulations with at most num_workers at a time.
+    With reuse_workload the first run of every workload writes the snapshot, the others wait for it."""
+    snapshots = {}  # workload key -> (snapshot path, state: running, ready or failed)
+    pending = list(runs)
+    running = []
+    while pending or running:
+        # Start runs while workers are free
+        i = 0
+        while len(running) < num_workers and i < len(pending):
+            run = pending[i]
+            if reuse_workload and "load-workload" not in run.options:
+                key = workload_key(run)
+                if key not in snapshots:
+                    path = os.path.join(workdir, "workload_{}.bin".format(len(snapshots)))
+                    snapshots[key] = [path, "running"]
+                    run.options["save-workload"] = path
+                elif snapshots[key][1] == "running":
+                    i += 1
+                    continue
+                elif snapshots[key][1] == "ready":
+                    run.options["load-workload"] = snapshots[key][0]
+            pending.pop(i)
+            start_run(run, executable, spec_dir)
+            running.append(run)
+        # Collect finished runs
+        for run in finished_runs(running):
+            status = "done" if run.returncode == 0 else "FAILED (exit code {}, see {})".format(run.returncode, run.log_file)
+            print("Point {} {}: {}".format(run.index, json.dumps(run.point), status), file=sys.stderr)
+            if "save-workload" in run.options:
+                # Without snapshot the waiting runs sample the workload themselves
+                snapshots[workload_key(run)][1] = "ready" if run.returncode == 0 else "failed"
+
+
+def merge(runs, output):
+    """Merge the job outputs of all successful runs with their sweep coordinates into one table"""
+    coordinates = list(runs[0].point.keys()) if runs else []
+    header = None
+    with (sys.stdout if output == "-" else open(output, "w")) as out:
+        for run in runs:
+            if run.returncode != 0 or not os.path.exists(run.output_file):
+                continue
+            with open(run.output_file) as f:
+                reader = csv.reader(f, skipinitialspace=True)
+                run_header = next(reader, None)
+                if run_header is None:
+                    continue
+                if header is None:
+                    header = run_header
+                    out.write(", ".join(["sweep.point"] + ["sweep." + c for c in coordinates] + header) + "\n")
+                elif run_header != header:
+                    raise RuntimeError("Output of point {} has a different format".format(run.index))
+                prefix = [str(run.index)] + [json.dumps(run.point[c]).strip('"') for c in coordinates]
+                for row in reader:
+                    out.write(", ".join(prefix + row) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Run a parameter sweep of the simulator in parallel processes and merge the job outputs"
+    )
+    parser.add_argument("specification", type=str, help="JSON file specifying the base options and the swept parameters")
+    parser.add_argument("--executable", type=str, default=None, help="simulator executable, overrides the specification")
+    parser.add_argument("--workers", "-j", type=int, default=os.cpu_count(), help="number of simulations run in parallel")
+    parser.add_argument("--workdir", type=str, default="sweep", help="directory for the outputs and logs of the single runs")
+    parser.add_argument("--output", type=str, default="sweep.csv", help="path of the merged result table, - for stdout")
+    parser.add_argument("--keep", action="store_true", help="keep the outputs of the single runs after merging")
+    args = parser.parse_args()
+
+    with open(args.specification) as f:
+        spec = json.load(f)
+    spec_dir = os.path.dirname(os.path.abspath(args.specification))
+    executable = args.executable or spec.get("executable", "dc-sim")
+    workdir = os.path.abspath(args.workdir)
+
+    runs = prepare_runs(spec, spec_dir, workdir)
+    print("Running {} sweep points with {} workers...".format(len(runs), args.workers), file=sys.stderr)
+    execute(runs, executable, spec_dir, workdir, max(1, args.workers), spec.get("reuse-workload", False))
+    merge(runs, args.output)
+
+    failed = [run for run in runs if run.returncode != 0]
+    if not args.keep and not failed:
+        for run in runs:
+            shutil.rmtree(run.directory)
+        for snapshot in os.listdir(workdir):
+            if snapshot.startswith("workload_") and snapshot.endswith(".bin"):
+                os.remove(os.path.join(workdir, snapshot))
+        if not os.listdir(workdir):
+            os.rmdir(workdir)
+    if failed:
+        print("{} of {} sweep points failed, their logs are kept in {}".format(len(failed), len(runs), workdir), file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()